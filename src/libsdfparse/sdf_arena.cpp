@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "sdf_arena.hpp"
+
+namespace /*anonymous*/ {
+
+//Blocks grow geometrically up to this size
+constexpr size_t MAX_BLOCK_SIZE = 64 << 20;
+
+} //namespace
+
+namespace sdfparse {
+
+void* Arena::allocate(size_t num_bytes, size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    uintptr_t pos = reinterpret_cast<uintptr_t>(pos_);
+    uintptr_t aligned = (pos + alignment - 1) & ~(alignment - 1);
+    if(!pos_ || aligned + num_bytes > reinterpret_cast<uintptr_t>(end_)) {
+        add_block(num_bytes + alignment);
+        pos = reinterpret_cast<uintptr_t>(pos_);
+        aligned = (pos + alignment - 1) & ~(alignment - 1);
+    }
+
+    pos_ += (aligned - pos) + num_bytes;
+    bytes_allocated_ += num_bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::adopt(Arena& other) {
+    //Keep allocating from our current block, but hold on to other's
+    for(auto& block : other.blocks_) {
+        blocks_.push_back(std::move(block));
+    }
+    bytes_allocated_ += other.bytes_allocated_;
+    bytes_reserved_ += other.bytes_reserved_;
+
+    other.blocks_.clear();
+    other.pos_ = nullptr;
+    other.end_ = nullptr;
+    other.bytes_allocated_ = 0;
+    other.bytes_reserved_ = 0;
+}
+
+void Arena::add_block(size_t min_size) {
+    size_t block_size = std::max(next_block_size_, min_size);
+    next_block_size_ = std::min(2 * next_block_size_, MAX_BLOCK_SIZE);
+
+    blocks_.emplace_back(new char[block_size]);
+    pos_ = blocks_.back().get();
+    end_ = pos_ + block_size;
+    bytes_reserved_ += block_size;
+}
+
+} //sdfparse
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+#include "sdf_array_view.hpp"
+
+namespace sdfparse {
+
+//A monotonic (bump pointer) allocator
+//
+//Memory is carved sequentially out of large blocks, and is only released
+//(all at once) when the Arena is destroyed. Objects stored in an Arena
+//must therefore be trivially destructible.
+class Arena {
+    public:
+        Arena() = default;
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        //Returns uninitialized memory of the specified size and alignment
+        void* allocate(size_t num_bytes, size_t alignment);
+
+        //Copies values into the arena, returning a (writable) view of the copy
+        template<typename T>
+        MutableArrayView<T> copy(ArrayView<T> values) {
+            static_assert(std::is_trivially_copyable<T>::value, "Arena values must be trivially copyable");
+            if(values.empty()) {
+                return MutableArrayView<T>();
+            }
+
+            void* mem = allocate(values.size() * sizeof(T), alignof(T));
+            std::memcpy(mem, values.data(), values.size() * sizeof(T));
+            return MutableArrayView<T>(static_cast<T*>(mem), values.size());
+        }
+
+        //Takes ownership of other's memory (which remains valid), leaving other empty
+        void adopt(Arena& other);
+
+        size_t num_blocks() const { return blocks_.size(); }
+        size_t bytes_allocated() const { return bytes_allocated_; } //Bytes handed out by allocate()
+        size_t bytes_reserved() const { return bytes_reserved_; } //Bytes held in blocks
+
+    private:
+        void add_block(size_t min_size);
+
+    private:
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char* pos_ = nullptr; //Next free byte in the current block
+        char* end_ = nullptr; //End of the current block
+        size_t next_block_size_ = 64 << 10;
+        size_t bytes_allocated_ = 0;
+        size_t bytes_reserved_ = 0;
+};
+
+} //sdfparse
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <vector>
+
+namespace sdfparse {
+
+//A non-owning view of a contiguous array of T
+//
+//The viewed storage (e.g. in an Arena) must outlive the view.
+template<typename T>
+class ArrayView {
+    public:
+        typedef const T* const_iterator;
+        typedef const T* iterator;
+
+        ArrayView() = default;
+        ArrayView(const T* new_data, size_t new_size)
+            : data_(new_data)
+            , size_(new_size)
+            {}
+        ArrayView(const std::vector<T>& vec)
+            : data_(vec.data())
+            , size_(vec.size())
+            {}
+
+        const T* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
+
+        const T& operator[](size_t i) const { assert(i < size_); return data_[i]; }
+        const T& front() const { assert(!empty()); return data_[0]; }
+        const T& back() const { assert(!empty()); return data_[size_ - 1]; }
+
+        //Copies the viewed values (e.g. for code written when lists were
+        //returned as std::vectors)
+        operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+    private:
+        const T* data_ = nullptr;
+        size_t size_ = 0;
+};
+
+//A non-owning view of a contiguous array of T, through which the elements
+//may be modified
+template<typename T>
+class MutableArrayView {
+    public:
+        typedef const T* const_iterator;
+        typedef T* iterator;
+
+        MutableArrayView() = default;
+        MutableArrayView(T* new_data, size_t new_size)
+            : data_(new_data)
+            , size_(new_size)
+            {}
+
+        T* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        T* begin() const { return data_; }
+        T* end() const { return data_ + size_; }
+
+        T& operator[](size_t i) const { assert(i < size_); return data_[i]; }
+
+        operator ArrayView<T>() const { return ArrayView<T>(data_, size_); }
+
+    private:
+        T* data_ = nullptr;
+        size_t size_ = 0;
+};
+
+} //sdfparse
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+#include "sdf_batch.hpp"
+#include "sdf_error.hpp"
+#include "sdf_parallel.hpp"
+
+namespace /*anonymous*/ {
+
+size_t file_size(const std::string& filename);
+sdfparse::Symbol prefixed_instance(sdfparse::SymbolTable& symbols, const std::string& prefix,
+                                   const std::string& divider, sdfparse::Symbol instance);
+
+//Returns the size of the file in bytes (0 if it can not be opened)
+size_t file_size(const std::string& filename) {
+    std::ifstream is(filename, std::ios::binary | std::ios::ate);
+    if(!is) return 0;
+    return static_cast<size_t>(is.tellg());
+}
+
+//Returns instance placed under the hierarchical path prefix
+sdfparse::Symbol prefixed_instance(sdfparse::SymbolTable& symbols, const std::string& prefix,
+                                   const std::string& divider, sdfparse::Symbol instance) {
+    if(prefix.empty()) {
+        return instance;
+    } else if(instance.str().empty()) {
+        return symbols.intern(prefix);
+    }
+    return symbols.intern(prefix + divider + instance.str());
+}
+
+} //namespace
+
+namespace sdfparse {
+
+//Loads one file of the batch, holding on to any error (and the filename
+//its location refers to) until it is reported
+class BatchLoader::FileLoader : public Loader {
+    public:
+        std::unique_ptr<ParseError> error;
+
+    protected:
+        void on_error(ParseError& parse_error) override {
+            if(!error) {
+                error.reset(new ParseError(parse_error));
+            }
+        }
+};
+
+BatchLoader::BatchLoader()
+    : lexer_type_(LexerType::FLEX) {
+}
+
+BatchLoader::~BatchLoader()
+    {}
+
+bool BatchLoader::load(const std::vector<std::string>& filenames) {
+    delayfiles_.clear();
+    delayfiles_.resize(filenames.size());
+
+    auto loaders = load_files(filenames, nullptr);
+
+    bool success = true;
+    for(size_t i = 0; i < loaders.size(); ++i) {
+        if(loaders[i]) {
+            Loader& loader = *loaders[i];
+            delayfiles_[i] = std::move(loader.delayfile_);
+        } else {
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool BatchLoader::load_merged(const std::vector<std::string>& filenames, const std::vector<std::string>& prefixes) {
+    assert(filenames.size() == prefixes.size());
+    delayfile_ = DelayFile();
+
+    //All the files intern their names in the merged table, so their cells
+    //can be combined without re-interning them
+    auto symbols = std::make_shared<SymbolTable>();
+    auto loaders = load_files(filenames, symbols);
+
+    for(size_t i = 0; i < loaders.size(); ++i) {
+        if(!loaders[i]) return false;
+    }
+    if(loaders.empty()) return true;
+
+    Header header = loaders[0]->get_delayfile().header();
+    const Timescale& timescale = header.timescale();
+    for(size_t i = 1; i < loaders.size(); ++i) {
+        const Timescale& file_timescale = loaders[i]->get_delayfile().header().timescale();
+        if(file_timescale.value() != timescale.value() || file_timescale.unit() != timescale.unit()) {
+            Loader& loader = *loaders[i];
+            auto pos = position(&loader.filename_);
+            ParseError error("TIMESCALE differs from that of " + filenames[0] + " (values can not be merged)",
+                             location(pos, pos));
+            on_error(i, error);
+            return false;
+        }
+    }
+
+    size_t num_cells = 0;
+    for(const auto& loader : loaders) {
+        num_cells += loader->get_delayfile().cells().size();
+    }
+
+    std::vector<Cell> cells;
+    cells.reserve(num_cells);
+
+    //The files' lists are already in their arenas, which we take over rather than copy
+    auto arena = std::make_shared<Arena>();
+    for(size_t i = 0; i < loaders.size(); ++i) {
+        Loader& loader = *loaders[i];
+        arena->adopt(*loader.arena_);
+
+        for(const Cell& cell : loader.delayfile_.cells()) {
+            Symbol instance = prefixed_instance(*symbols, prefixes[i], header.divider(), cell.instance_symbol());
+            cells.emplace_back(cell.celltype_symbol(), instance, cell.delay(), cell.timing_check());
+        }
+        loaders[i].reset();
+    }
+
+    delayfile_ = DelayFile(std::move(header), std::move(cells), symbols, arena);
+    return true;
+}
+
+void BatchLoader::on_error(size_t /*ifile*/, ParseError& error) {
+    //Default implementation, just print out the error
+    std::cout << "SDF Error " << error.loc() << ": " << error.what() << "\n";
+}
+
+std::vector<std::unique_ptr<BatchLoader::FileLoader>> BatchLoader::load_files(const std::vector<std::string>& filenames,
+                                                                              std::shared_ptr<SymbolTable> symbols) {
+    size_t num_files = filenames.size();
+    size_t num_threads = (num_threads_ > 0) ? num_threads_ : default_num_threads();
+
+    //Spare threads parse the files in parallel
+    size_t threads_per_file = (num_files > 0) ? std::max<size_t>(1, num_threads / num_files) : 1;
+
+    //Start with the largest files, so a large file started last
+    //does not leave the other threads idle
+    std::vector<size_t> sizes(num_files);
+    for(size_t i = 0; i < num_files; ++i) {
+        sizes[i] = file_size(filenames[i]);
+    }
+    std::vector<size_t> order(num_files);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return sizes[lhs] > sizes[rhs];
+    });
+
+    std::vector<std::unique_ptr<FileLoader>> loaders(num_files);
+    std::vector<char> succeeded(num_files, false);
+    parallel_for(num_files, num_threads, [&](size_t i) {
+        size_t ifile = order[i];
+
+        std::unique_ptr<FileLoader> file_loader(new FileLoader());
+        Loader& loader = *file_loader;
+        loader.set_lexer_type(lexer_type_);
+        loader.set_cell_storage(cell_storage_);
+        loader.shared_symbols_ = symbols;
+
+        if(threads_per_file > 1) {
+            succeeded[ifile] = loader.load_parallel(filenames[ifile], threads_per_file);
+        } else {
+            succeeded[ifile] = loader.load_mapped(filenames[ifile]);
+        }
+
+        loaders[ifile] = std::move(file_loader);
+    });
+
+    //Report the errors in input order
+    for(size_t ifile = 0; ifile < num_files; ++ifile) {
+        if(succeeded[ifile]) continue;
+
+        if(loaders[ifile]->error) {
+            on_error(ifile, *loaders[ifile]->error);
+        }
+        loaders[ifile].reset();
+    }
+    return loaders;
+}
+
+} //sdfparse
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_loader.hpp"
+
+namespace sdfparse {
+
+//Class for loading many SDF files (e.g. one per block and corner) concurrently.
+//
+//The files are loaded on a pool of threads, each of which repeatedly takes
+//the next (largest remaining) file, so at most num_threads() files are in
+//flight at once and threads which finish early pick up the remaining work.
+//Each file is loaded by its own Loader (with load_mapped(), so compressed
+//files are also supported); if there are fewer files than threads, the
+//spare threads are used to parse each file in parallel (with load_parallel()).
+//
+//load() returns one DelayFile per file (see get_delayfiles()), while
+//load_merged() combines the files into a single DelayFile (see get_delayfile()),
+//with each file's instances prefixed by its hierarchical path in the design.
+//
+//Errors are passed to on_error() once all the files have been loaded, on the
+//calling thread and in input order. By default they are printed, as with Loader.
+class BatchLoader {
+
+    public:
+        BatchLoader();
+        virtual ~BatchLoader();
+
+        //Loads each of the files, returning true if all succeeded.
+        //get_delayfiles()[i] is the result for filenames[i] (empty if it failed).
+        bool load(const std::vector<std::string>& filenames);
+
+        //Loads the files and merges their cells (in input order) into a single
+        //DelayFile, returning true if all succeeded.
+        //
+        //Each file's instances are prefixed with prefixes[i], joined with the
+        //divider; a cell with an empty instance (i.e. for the file's top-level
+        //design) becomes the prefix itself, and an empty prefix leaves the
+        //instances unchanged. The merged header is that of the first file. The
+        //files must share a timescale, since their values are not converted.
+        bool load_merged(const std::vector<std::string>& filenames, const std::vector<std::string>& prefixes);
+
+        const std::vector<DelayFile>& get_delayfiles() const { return delayfiles_; }
+        const DelayFile& get_delayfile() const { return delayfile_; }
+
+        void set_lexer_type(LexerType type) { lexer_type_ = type; }
+        LexerType lexer_type() const { return lexer_type_; }
+
+        //How the lists of loaded cells are stored (see Loader::set_cell_storage())
+        void set_cell_storage(CellStorage storage) { cell_storage_ = storage; }
+        CellStorage cell_storage() const { return cell_storage_; }
+
+        //The number of threads to use (0, the default, uses one per hardware thread)
+        void set_num_threads(size_t num_threads) { num_threads_ = num_threads; }
+        size_t num_threads() const { return num_threads_; }
+
+    protected:
+        //Called for each file which failed to load (ifile is its index in the input)
+        virtual void on_error(size_t ifile, ParseError& error);
+
+    private:
+        class FileLoader;
+
+        //Loads the files concurrently, interning names in symbols (if not null).
+        //Errors are reported, after which failed files have a null loader.
+        std::vector<std::unique_ptr<FileLoader>> load_files(const std::vector<std::string>& filenames,
+                                                            std::shared_ptr<SymbolTable> symbols);
+
+    private:
+        LexerType lexer_type_;
+        CellStorage cell_storage_ = CellStorage::HEAP;
+        size_t num_threads_ = 0;
+
+        std::vector<DelayFile> delayfiles_; //Results of load()
+        DelayFile delayfile_; //Result of load_merged()
+};
+
+} //sdfparse
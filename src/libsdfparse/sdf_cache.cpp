@@ -0,0 +1,513 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <unordered_map>
+
+#include "sdf_cache.hpp"
+#include "sdf_mmap.hpp"
+#include "sdf_posix_io.hpp"
+
+#if SDFPARSE_HAVE_POSIX_IO
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace /*anonymous*/ {
+
+using namespace sdfparse;
+
+constexpr char CACHE_MAGIC[8] = {'S', 'D', 'F', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t CACHE_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//Marks a null Symbol
+constexpr uint32_t NO_STRING = uint32_t(-1);
+
+//The fixed-size header at the start of a cache file
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    SourceStamp source;
+    uint64_t payload_size;
+    uint64_t payload_checksum;
+};
+
+//Appends values to a byte buffer
+class ByteWriter {
+    public:
+        template<typename T>
+        void put(const T& value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            buf_.insert(buf_.end(), bytes, bytes + sizeof(T));
+        }
+
+        void put_string(const std::string& str) {
+            put<uint32_t>(str.size());
+            buf_.insert(buf_.end(), str.begin(), str.end());
+        }
+
+        std::vector<char>& buffer() { return buf_; }
+
+    private:
+        std::vector<char> buf_;
+};
+
+//Reads values from a byte range, failing (rather than reading past the end)
+//if the range is too short
+class ByteReader {
+    public:
+        ByteReader(const char* begin, const char* end)
+            : pos_(begin)
+            , end_(end)
+            {}
+
+        template<typename T>
+        bool get(T& value) {
+            if(size_t(end_ - pos_) < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return true;
+        }
+
+        bool get_string(std::string& str) {
+            uint32_t size;
+            if(!get(size) || size_t(end_ - pos_) < size) {
+                return false;
+            }
+            str.assign(pos_, size);
+            pos_ += size;
+            return true;
+        }
+
+        bool at_end() const { return pos_ == end_; }
+
+    private:
+        const char* pos_;
+        const char* end_;
+};
+
+//Assigns string table indices to Symbols
+class StringTableBuilder {
+    public:
+        uint32_t index(Symbol symbol) {
+            if(symbol.is_null()) {
+                return NO_STRING;
+            }
+            auto result = indices_.emplace(&symbol.str(), uint32_t(strings_.size()));
+            if(result.second) {
+                strings_.push_back(&symbol.str());
+            }
+            return result.first->second;
+        }
+
+        void write(ByteWriter& writer) const {
+            writer.put<uint64_t>(strings_.size());
+            for(const std::string* str : strings_) {
+                writer.put_string(*str);
+            }
+        }
+
+    private:
+        std::unordered_map<const std::string*, uint32_t> indices_;
+        std::vector<const std::string*> strings_;
+};
+
+uint64_t fnv1a_hash(const char* begin, const char* end);
+bool get_symbol(ByteReader& reader, const std::vector<Symbol>& strings, Symbol& symbol);
+bool get_port_spec(ByteReader& reader, const std::vector<Symbol>& strings, PortSpec& port_spec);
+bool get_real_triple(ByteReader& reader, RealTriple& triple);
+void put_port_spec(ByteWriter& writer, StringTableBuilder& strings, const PortSpec& port_spec);
+void put_real_triple(ByteWriter& writer, const RealTriple& triple);
+bool write_temporary_file(const std::string& cache_filename, const CacheHeader& cache_header,
+                          const std::vector<char>& payload, std::string& tmp_filename);
+#if SDFPARSE_HAVE_POSIX_IO
+bool write_fd(int fd, const char* data, size_t size);
+mode_t process_umask();
+#endif
+//Writes the cache to a new file next to cache_filename (so it can be
+//renamed over it), returning its name in tmp_filename
+bool write_temporary_file(const std::string& cache_filename, const CacheHeader& cache_header,
+                          const std::vector<char>& payload, std::string& tmp_filename) {
+#if SDFPARSE_HAVE_POSIX_IO
+    //A uniquely named file, so concurrent writers of the same cache do not
+    //clobber each other's output
+    tmp_filename = cache_filename + ".XXXXXX";
+    int fd = ::mkstemp(&tmp_filename[0]);
+    if(fd < 0) {
+        return false;
+    }
+
+    //mkstemp() creates the file readable only by its owner, so give it the
+    //mode open() would have (rw for all, less the umask)
+    bool written = ::fchmod(fd, 0666 & ~process_umask()) == 0
+                   && write_fd(fd, reinterpret_cast<const char*>(&cache_header), sizeof(cache_header))
+                   && write_fd(fd, payload.data(), payload.size());
+    written = (::close(fd) == 0) && written;
+#else
+    tmp_filename = cache_filename + ".tmp";
+    bool written;
+    {
+        std::ofstream os(tmp_filename, std::ios::binary | std::ios::trunc);
+        os.write(reinterpret_cast<const char*>(&cache_header), sizeof(cache_header));
+        os.write(payload.data(), payload.size());
+        written = bool(os.flush());
+    }
+#endif
+    if(!written) {
+        std::remove(tmp_filename.c_str());
+    }
+    return written;
+}
+
+#if SDFPARSE_HAVE_POSIX_IO
+//The umask can only be read by setting it, so it is read once (briefly
+//setting it to 0) and the result reused
+mode_t process_umask() {
+    static const mode_t mask = [] {
+        mode_t current = ::umask(0);
+        ::umask(current);
+        return current;
+    }();
+    return mask;
+}
+
+bool write_fd(int fd, const char* data, size_t size) {
+    while(size > 0) {
+        ssize_t num_written = ::write(fd, data, size);
+        if(num_written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += num_written;
+        size -= num_written;
+    }
+    return true;
+}
+#endif
+
+bool read_payload(const char* begin, const char* end, SymbolTable& symbols, Arena& arena,
+                  Header& header, std::vector<Cell>& cells);
+
+//64-bit FNV-1a, applied to 8-byte words (then any trailing bytes) for speed
+uint64_t fnv1a_hash(const char* begin, const char* end) {
+    const uint64_t FNV_PRIME = UINT64_C(0x100000001b3);
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    const char* pos = begin;
+    for(; end - pos >= 8; pos += 8) {
+        uint64_t word;
+        std::memcpy(&word, pos, sizeof(word));
+        hash ^= word;
+        hash *= FNV_PRIME;
+    }
+    for(; pos != end; ++pos) {
+        hash ^= static_cast<unsigned char>(*pos);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+bool get_symbol(ByteReader& reader, const std::vector<Symbol>& strings, Symbol& symbol) {
+    uint32_t index;
+    if(!reader.get(index)) {
+        return false;
+    }
+    if(index == NO_STRING) {
+        symbol = Symbol();
+        return true;
+    }
+    if(index >= strings.size()) {
+        return false;
+    }
+    symbol = strings[index];
+    return true;
+}
+
+bool get_port_spec(ByteReader& reader, const std::vector<Symbol>& strings, PortSpec& port_spec) {
+    Symbol port;
+    uint8_t condition;
+    if(!get_symbol(reader, strings, port) || !reader.get(condition)
+       || condition > static_cast<uint8_t>(PortCondition::NONE)) {
+        return false;
+    }
+    port_spec = PortSpec(port, static_cast<PortCondition>(condition));
+    return true;
+}
+
+bool get_real_triple(ByteReader& reader, RealTriple& triple) {
+    double min, typ, max;
+    if(!reader.get(min) || !reader.get(typ) || !reader.get(max)) {
+        return false;
+    }
+    triple = RealTriple(min, typ, max);
+    return true;
+}
+
+void put_port_spec(ByteWriter& writer, StringTableBuilder& strings, const PortSpec& port_spec) {
+    writer.put<uint32_t>(strings.index(port_spec.port_symbol()));
+    writer.put<uint8_t>(static_cast<uint8_t>(port_spec.condition()));
+}
+
+void put_real_triple(ByteWriter& writer, const RealTriple& triple) {
+    writer.put<double>(triple.min());
+    writer.put<double>(triple.typ());
+    writer.put<double>(triple.max());
+}
+
+bool read_payload(const char* begin, const char* end, SymbolTable& symbols, Arena& arena,
+                  Header& header, std::vector<Cell>& cells) {
+    ByteReader reader(begin, end);
+
+    //String table
+    uint64_t num_strings;
+    if(!reader.get(num_strings) || num_strings > uint64_t(end - begin)) {
+        return false;
+    }
+    std::vector<Symbol> strings;
+    strings.reserve(num_strings);
+    std::string str;
+    for(uint64_t i = 0; i < num_strings; ++i) {
+        if(!reader.get_string(str)) {
+            return false;
+        }
+        strings.push_back(symbols.intern(std::move(str)));
+    }
+
+    //SDF header
+    std::string sdfversion, design, vendor, program, version, divider, timescale_unit;
+    double timescale_value;
+    if(!reader.get_string(sdfversion) || !reader.get_string(design) || !reader.get_string(vendor)
+       || !reader.get_string(program) || !reader.get_string(version) || !reader.get_string(divider)
+       || !reader.get(timescale_value) || !reader.get_string(timescale_unit)) {
+        return false;
+    }
+    header = Header(sdfversion, divider, Timescale(timescale_value, timescale_unit));
+    header.set_design(design);
+    header.set_vendor(vendor);
+    header.set_program(program);
+    header.set_version(version);
+
+    //Cells, with their IOPATHs and timing checks
+    uint64_t num_cells;
+    if(!reader.get(num_cells) || num_cells > uint64_t(end - begin)) {
+        return false;
+    }
+    cells.clear();
+    cells.reserve(num_cells);
+    for(uint64_t icell = 0; icell < num_cells; ++icell) {
+        Symbol celltype, instance;
+        uint32_t num_iopaths, num_timings;
+        if(!get_symbol(reader, strings, celltype) || !get_symbol(reader, strings, instance)
+           || !reader.get(num_iopaths) || !reader.get(num_timings)
+           || num_iopaths > uint64_t(end - begin) || num_timings > uint64_t(end - begin)) {
+            return false;
+        }
+
+        //Construct the lists directly in the arena (the elements are trivially destructible)
+        Iopath* iopaths = nullptr;
+        if(num_iopaths > 0) {
+            iopaths = static_cast<Iopath*>(arena.allocate(num_iopaths * sizeof(Iopath), alignof(Iopath)));
+        }
+        for(uint32_t i = 0; i < num_iopaths; ++i) {
+            PortSpec input, output;
+            RealTriple rise, fall;
+            if(!get_port_spec(reader, strings, input) || !get_port_spec(reader, strings, output)
+               || !get_real_triple(reader, rise) || !get_real_triple(reader, fall)) {
+                return false;
+            }
+            new (&iopaths[i]) Iopath(input, output, rise, fall);
+        }
+
+        Timing* timings = nullptr;
+        if(num_timings > 0) {
+            timings = static_cast<Timing*>(arena.allocate(num_timings * sizeof(Timing), alignof(Timing)));
+        }
+        for(uint32_t i = 0; i < num_timings; ++i) {
+            uint8_t type;
+            PortSpec clock, port;
+            RealTriple t;
+            if(!reader.get(type) || type > static_cast<uint8_t>(TimingType::REMOVAL)
+               || !get_port_spec(reader, strings, clock) || !get_port_spec(reader, strings, port)
+               || !get_real_triple(reader, t)) {
+                return false;
+            }
+            new (&timings[i]) Timing(clock, port, t, static_cast<TimingType>(type));
+        }
+
+        cells.emplace_back(celltype, instance,
+                           Delay(Delay::Type::ABSOLUTE, ArrayView<Iopath>(iopaths, num_iopaths)),
+                           TimingCheck(ArrayView<Timing>(timings, num_timings)));
+    }
+
+    return reader.at_end();
+}
+
+} //namespace
+
+namespace sdfparse {
+
+bool stamp_sdf_file(const std::string& filename, bool with_hash, SourceStamp& stamp) {
+    stamp = SourceStamp();
+
+#if SDFPARSE_HAVE_POSIX_IO
+    struct stat st;
+    if(::stat(filename.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(st.st_size);
+# if defined(__APPLE__)
+    stamp.mtime_ns = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+# else
+    stamp.mtime_ns = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+# endif
+
+    if(with_hash) {
+        MappedFile mapped_file;
+        if(!mapped_file.open(filename)) {
+            return false;
+        }
+        stamp.hash = fnv1a_hash(mapped_file.begin(), mapped_file.end());
+    }
+#else
+    //Without stat() the modification time is unknown, so always hash
+    (void) with_hash;
+    std::ifstream is(filename, std::ios::binary);
+    if(!is) {
+        return false;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    stamp.size = contents.size();
+    stamp.hash = fnv1a_hash(contents.data(), contents.data() + contents.size());
+#endif
+    return true;
+}
+
+bool source_stamps_match(const SourceStamp& cached, const SourceStamp& current) {
+    if(cached.size != current.size) {
+        return false;
+    }
+    if(cached.hash != 0 && current.hash != 0) {
+        return cached.hash == current.hash;
+    }
+    return cached.mtime_ns == current.mtime_ns;
+}
+
+bool write_sdf_cache(const std::string& cache_filename, const DelayFile& delayfile, const SourceStamp& source) {
+    //Encode the cells first, so the string table is complete
+    StringTableBuilder strings;
+    ByteWriter body;
+
+    const Header& header = delayfile.header();
+    body.put_string(header.sdfversion());
+    body.put_string(header.design());
+    body.put_string(header.vendor());
+    body.put_string(header.program());
+    body.put_string(header.version());
+    body.put_string(header.divider());
+    body.put<double>(header.timescale().value());
+    body.put_string(header.timescale().unit());
+
+    body.put<uint64_t>(delayfile.cells().size());
+    for(const Cell& cell : delayfile.cells()) {
+        auto iopaths = cell.delay().iopaths();
+        auto timings = cell.timing_check().timing();
+
+        body.put<uint32_t>(strings.index(cell.celltype_symbol()));
+        body.put<uint32_t>(strings.index(cell.instance_symbol()));
+        body.put<uint32_t>(iopaths.size());
+        body.put<uint32_t>(timings.size());
+
+        for(const Iopath& iopath : iopaths) {
+            put_port_spec(body, strings, iopath.input());
+            put_port_spec(body, strings, iopath.output());
+            put_real_triple(body, iopath.rise());
+            put_real_triple(body, iopath.fall());
+        }
+
+        for(const Timing& timing : timings) {
+            body.put<uint8_t>(static_cast<uint8_t>(timing.timing_type()));
+            put_port_spec(body, strings, timing.clock());
+            put_port_spec(body, strings, timing.port());
+            put_real_triple(body, timing.t());
+        }
+    }
+
+    ByteWriter payload;
+    strings.write(payload);
+    std::vector<char>& payload_buf = payload.buffer();
+    payload_buf.insert(payload_buf.end(), body.buffer().begin(), body.buffer().end());
+
+    CacheHeader cache_header;
+    std::memcpy(cache_header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    cache_header.version = CACHE_VERSION;
+    cache_header.byte_order_mark = BYTE_ORDER_MARK;
+    cache_header.source = source;
+    cache_header.payload_size = payload_buf.size();
+    cache_header.payload_checksum = fnv1a_hash(payload_buf.data(), payload_buf.data() + payload_buf.size());
+
+    std::string tmp_filename;
+    if(!write_temporary_file(cache_filename, cache_header, payload_buf, tmp_filename)) {
+        return false;
+    }
+
+    if(std::rename(tmp_filename.c_str(), cache_filename.c_str()) != 0) {
+        std::remove(tmp_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_sdf_cache(const std::string& cache_filename, const SourceStamp& source,
+                    SymbolTable& symbols, Arena& arena, Header& header, std::vector<Cell>& cells) {
+#if SDFPARSE_HAVE_MMAP
+    MappedFile mapped_file;
+    if(!mapped_file.open(cache_filename)) {
+        return false;
+    }
+    const char* begin = mapped_file.begin();
+    const char* end = mapped_file.end();
+#else
+    std::ifstream is(cache_filename, std::ios::binary);
+    if(!is) {
+        return false;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    const char* begin = contents.data();
+    const char* end = contents.data() + contents.size();
+#endif
+
+    CacheHeader cache_header;
+    if(size_t(end - begin) < sizeof(cache_header)) {
+        return false;
+    }
+    std::memcpy(&cache_header, begin, sizeof(cache_header));
+    const char* payload = begin + sizeof(cache_header);
+
+    if(std::memcmp(cache_header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+       || cache_header.version != CACHE_VERSION
+       || cache_header.byte_order_mark != BYTE_ORDER_MARK
+       || cache_header.payload_size != uint64_t(end - payload)) {
+        return false; //Not a (compatible) cache file, or truncated
+    }
+
+    if(!source_stamps_match(cache_header.source, source)) {
+        return false; //Stale
+    }
+
+    if(fnv1a_hash(payload, end) != cache_header.payload_checksum) {
+        return false; //Corrupt
+    }
+
+    return read_payload(payload, end, symbols, arena, header, cells);
+}
+
+} //sdfparse
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sdf_data.hpp"
+
+namespace sdfparse {
+
+//Binary cache files
+//
+//A cache file holds a parsed DelayFile in a compact binary form which can
+//be reloaded (via mmap) without lexing or parsing. It consists of a
+//fixed-size header followed by the payload:
+//
+//  header:  magic ("SDFCACHE"), format version, byte order mark,
+//           the SourceStamp of the SDF file it was built from,
+//           and the payload size and checksum (FNV-1a)
+//  payload: the string table (each distinct name once), the SDF header,
+//           then flat arrays of the cells, IOPATHs and timing checks
+//           (cells refer to names by their string table index, and own
+//           the next num_iopaths/num_timings entries of those arrays)
+//
+//Values are stored in the native byte order; caches written on a machine
+//with a different byte order (or in a different format version) are
+//rejected, as are corrupt or stale ones.
+
+//Identifies the version of an SDF file a cache was built from
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtime_ns = 0; //Modification time (ns since the epoch)
+    uint64_t hash = 0; //Hash of the file contents (0 if not computed)
+};
+
+//Determines the stamp of the specified SDF file (hashing its contents if
+//with_hash is true), returning false if it can not be read.
+bool stamp_sdf_file(const std::string& filename, bool with_hash, SourceStamp& stamp);
+
+//Returns true if a cache built from a file with stamp cached is valid for
+//a file with stamp current. The contents hashes are compared if both are
+//known, otherwise the modification times.
+bool source_stamps_match(const SourceStamp& cached, const SourceStamp& current);
+
+//Writes delayfile (built from the SDF file identified by source) to the
+//cache file, returning true if successful.
+//
+//The cache is written to a uniquely named temporary file (created with
+//mkstemp() where available) in the same directory, which is then renamed,
+//so concurrent readers never see a partially written cache and concurrent
+//writers do not corrupt each other's output (the last rename wins).
+bool write_sdf_cache(const std::string& cache_filename, const DelayFile& delayfile, const SourceStamp& source);
+
+//Reads the cache file, returning false if it is missing, corrupt or not
+//valid for the SDF file identified by source.
+//
+//Names are interned in symbols, and IOPATH/timing check lists are stored
+//in arena. Every name is copied from the cache's string table into
+//symbols (Symbols refer to strings owned by a SymbolTable, so they cannot
+//point into the mapped file), which is a significant part of the load
+//time for caches of large designs.
+bool read_sdf_cache(const std::string& cache_filename, const SourceStamp& source,
+                    SymbolTable& symbols, Arena& arena, Header& header, std::vector<Cell>& cells);
+
+} //sdfparse
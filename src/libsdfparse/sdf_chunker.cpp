@@ -0,0 +1,313 @@
+#include <cstring>
+#include <algorithm>
+
+#include "sdf_chunker.hpp"
+#include "sdf_parallel.hpp"
+
+namespace /*anonymous*/ {
+
+//Summary of the parenthesis structure of a segment of text
+struct SegmentSummary {
+    long depth_change = 0; //Net change in parenthesis depth across the segment
+    long min_depth = 0; //Minimum depth reached, relative to the start of the segment
+    size_t num_lines = 0; //Number of line breaks in the segment
+};
+
+//The first top-level CELL at or after the start of a segment
+struct CellStart {
+    const char* pos = nullptr;
+    unsigned line = 0;
+};
+
+bool is_space(char c);
+bool is_ident_char(char c);
+bool is_cell_start(const char* p, const char* end);
+bool find_delayfile_body(const char* begin, const char* end, const char*& body_begin, const char*& body_end);
+const char* skip_spaces(const char* p, const char* end);
+const char* match_keyword(const char* p, const char* end, const char* keyword);
+bool read_cell_names(const char* p, const char* end, sdfparse::CellText& cell);
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool is_ident_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+           || (c != '\0' && std::strchr("-_~|*/[].{}^+$\\", c));
+}
+
+//Returns true if the '(' at p starts a CELL definition
+bool is_cell_start(const char* p, const char* end) {
+    ++p; //Skip '('
+    while(p != end && is_space(*p)) ++p;
+
+    const size_t len = 4;
+    if(static_cast<size_t>(end - p) < len || std::memcmp(p, "CELL", len) != 0) {
+        return false;
+    }
+    p += len;
+    return p == end || !is_ident_char(*p);
+}
+
+//Finds the body of the DELAYFILE (i.e. between its parentheses)
+bool find_delayfile_body(const char* begin, const char* end, const char*& body_begin, const char*& body_end) {
+    body_begin = begin;
+    while(body_begin != end && is_space(*body_begin)) ++body_begin;
+    if(body_begin == end || *body_begin != '(') {
+        return false;
+    }
+    ++body_begin;
+
+    body_end = end;
+    while(body_end != body_begin && is_space(body_end[-1])) --body_end;
+    if(body_end == body_begin || body_end[-1] != ')') {
+        return false;
+    }
+    --body_end;
+    return true;
+}
+
+const char* skip_spaces(const char* p, const char* end) {
+    while(p != end && is_space(*p)) ++p;
+    return p;
+}
+
+//Returns the position after keyword if it is at p (as a whole token), otherwise nullptr
+const char* match_keyword(const char* p, const char* end, const char* keyword) {
+    size_t len = std::strlen(keyword);
+    if(static_cast<size_t>(end - p) < len || std::memcmp(p, keyword, len) != 0) {
+        return nullptr;
+    }
+    p += len;
+    return (p == end || !is_ident_char(*p)) ? p : nullptr;
+}
+
+//Reads the CELLTYPE and INSTANCE names of the cell starting at p (just
+//after its '(CELL'), returning false if they are not in the usual form
+bool read_cell_names(const char* p, const char* end, sdfparse::CellText& cell) {
+    //(CELLTYPE "celltype")
+    p = skip_spaces(p, end);
+    if(p == end || *p != '(') return false;
+    p = match_keyword(skip_spaces(p + 1, end), end, "CELLTYPE");
+    if(!p) return false;
+    p = skip_spaces(p, end);
+    if(p == end || *p != '"') return false;
+    const char* celltype_begin = ++p;
+    while(p != end && is_ident_char(*p)) ++p;
+    if(p == end || *p != '"' || p == celltype_begin) return false;
+    const char* celltype_end = p++;
+    p = skip_spaces(p, end);
+    if(p == end || *p != ')') return false;
+
+    //(INSTANCE instance)
+    p = skip_spaces(p + 1, end);
+    if(p == end || *p != '(') return false;
+    p = match_keyword(skip_spaces(p + 1, end), end, "INSTANCE");
+    if(!p) return false;
+    p = skip_spaces(p, end);
+    const char* instance_begin = p;
+    while(p != end && is_ident_char(*p)) ++p;
+    const char* instance_end = p;
+    p = skip_spaces(p, end);
+    if(p == end || *p != ')' || instance_begin == instance_end) return false;
+
+    //Identifiers which could be lexed as numbers are left to the parser
+    char first = *instance_begin;
+    if((first >= '0' && first <= '9') || first == '.' || first == '-' || first == '+') {
+        return false;
+    }
+
+    cell.celltype_begin = celltype_begin;
+    cell.celltype_end = celltype_end;
+    cell.instance_begin = instance_begin;
+    cell.instance_end = instance_end;
+    return true;
+}
+
+} //namespace
+
+namespace sdfparse {
+
+bool split_sdf_cells(const char* begin, const char* end,
+                     size_t num_chunks, size_t num_threads,
+                     TextChunk& header, std::vector<TextChunk>& cell_chunks) {
+    cell_chunks.clear();
+
+    const char* body_begin = nullptr;
+    const char* body_end = nullptr;
+    if(!find_delayfile_body(begin, end, body_begin, body_end)) {
+        return false;
+    }
+
+    size_t body_size = body_end - body_begin;
+    size_t num_segments = std::max<size_t>(1, std::min(num_chunks, body_size));
+    auto segment_begin = [&](size_t i) {
+        return body_begin + (i * body_size) / num_segments;
+    };
+
+    //Summarize each segment in parallel
+    std::vector<SegmentSummary> summaries(num_segments);
+    parallel_for(num_segments, num_threads, [&](size_t i) {
+        SegmentSummary summary;
+        const char* seg_end = segment_begin(i + 1);
+        for(const char* p = segment_begin(i); p != seg_end; ++p) {
+            char c = *p;
+            if(c == '(') {
+                ++summary.depth_change;
+            } else if(c == ')') {
+                --summary.depth_change;
+                summary.min_depth = std::min(summary.min_depth, summary.depth_change);
+            } else if(c == '\n') {
+                ++summary.num_lines;
+            }
+        }
+        summaries[i] = summary;
+    });
+
+    //Determine the depth and line at the start of each segment, and verify
+    //that the body never closes the DELAYFILE early
+    std::vector<long> start_depths(num_segments);
+    std::vector<unsigned> start_lines(num_segments);
+    long depth = 1;
+    unsigned line = 1 + static_cast<unsigned>(std::count(begin, body_begin, '\n'));
+    for(size_t i = 0; i < num_segments; ++i) {
+        if(depth + summaries[i].min_depth < 1) {
+            return false;
+        }
+        start_depths[i] = depth;
+        start_lines[i] = line;
+        depth += summaries[i].depth_change;
+        line += summaries[i].num_lines;
+    }
+    if(depth != 1) {
+        return false; //Unbalanced
+    }
+
+    //Find the first top-level cell at or after the start of each segment in parallel.
+    //
+    //Note that a segment may contain no cell start (e.g. if it is within
+    //a very large cell), in which case the search continues into later
+    //segments and finds the same cell as its successor.
+    std::vector<CellStart> cell_starts(num_segments);
+    parallel_for(num_segments, num_threads, [&](size_t i) {
+        long seg_depth = start_depths[i];
+        unsigned seg_line = start_lines[i];
+        for(const char* p = segment_begin(i); p != body_end; ++p) {
+            char c = *p;
+            if(c == '(') {
+                if(seg_depth == 1 && is_cell_start(p, body_end)) {
+                    cell_starts[i].pos = p;
+                    cell_starts[i].line = seg_line;
+                    return;
+                }
+                ++seg_depth;
+            } else if(c == ')') {
+                --seg_depth;
+            } else if(c == '\n') {
+                ++seg_line;
+            }
+        }
+        cell_starts[i].pos = body_end;
+    });
+
+    if(cell_starts[0].pos == body_end) {
+        return false; //No cells
+    }
+
+    header.begin = begin;
+    header.end = cell_starts[0].pos;
+    header.line = 1;
+    header.column = 1;
+
+    for(size_t i = 0; i < num_segments; ++i) {
+        const CellStart& start = cell_starts[i];
+        if(start.pos == body_end) {
+            break; //No more cells
+        }
+        if(!cell_chunks.empty() && cell_chunks.back().begin == start.pos) {
+            continue; //Same as previous segment
+        }
+
+        if(!cell_chunks.empty()) {
+            cell_chunks.back().end = start.pos;
+        }
+
+        TextChunk chunk;
+        chunk.begin = start.pos;
+        chunk.end = body_end;
+        chunk.line = start.line;
+        chunk.column = text_column(begin, start.pos);
+        cell_chunks.push_back(chunk);
+    }
+
+    return true;
+}
+
+bool scan_sdf_cells(const char* begin, const char* end, TextChunk& header,
+                    const std::function<void(const CellText&)>& on_cell) {
+    const char* body_begin = nullptr;
+    const char* body_end = nullptr;
+    if(!find_delayfile_body(begin, end, body_begin, body_end)) {
+        return false;
+    }
+
+    header.begin = begin;
+    header.end = body_end;
+    header.line = 1;
+    header.column = 1;
+
+    long depth = 1;
+    unsigned line = 1 + static_cast<unsigned>(std::count(begin, body_begin, '\n'));
+    CellText cell;
+    bool seen_cell = false;
+    for(const char* p = body_begin; p != body_end; ++p) {
+        char c = *p;
+        if(c == '(') {
+            if(depth == 1) {
+                const char* after_keyword = match_keyword(skip_spaces(p + 1, body_end), body_end, "CELL");
+                if(after_keyword) {
+                    if(!seen_cell) {
+                        header.end = p;
+                        seen_cell = true;
+                    }
+                    cell = CellText();
+                    cell.text.begin = p;
+                    cell.text.line = line;
+                    cell.text.column = text_column(begin, p);
+                    read_cell_names(after_keyword, body_end, cell);
+                } else if(seen_cell) {
+                    return false; //Only cells may follow the first cell
+                }
+            }
+            ++depth;
+        } else if(c == ')') {
+            --depth;
+            if(depth < 1) {
+                return false; //Closes the DELAYFILE early
+            } else if(depth == 1 && cell.text.begin) {
+                cell.text.end = p + 1;
+                on_cell(cell);
+                cell.text.begin = nullptr;
+            }
+        } else if(c == '\n') {
+            ++line;
+        }
+    }
+    return depth == 1;
+}
+
+//Returns the column of p, as counted by the lexer
+unsigned text_column(const char* begin, const char* p) {
+    const char* line_start = p;
+    while(line_start != begin && line_start[-1] != '\n') {
+        --line_start;
+    }
+
+    //The lexer treats '\n\r' as a single line break
+    if(line_start != begin && line_start != p && *line_start == '\r') {
+        ++line_start;
+    }
+    return static_cast<unsigned>(p - line_start) + 1;
+}
+
+} //sdfparse
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace sdfparse {
+
+//A contiguous range of SDF text, and the line/column of its first character
+struct TextChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    unsigned line = 1;
+    unsigned column = 1;
+};
+
+//Splits the SDF text in [begin, end) into its header and runs of complete
+//top-level CELL definitions, which can then be parsed independently.
+//
+//Boundaries are found by tracking parenthesis depth (neither identifiers nor
+//quoted strings may contain parentheses). The text is scanned in
+//(approximately) num_chunks segments, using up to num_threads threads.
+//
+//On success, header covers everything from the start of the file up to
+//the first CELL, and cell_chunks holds consecutive ranges which each begin
+//with a top-level '(CELL' and together cover all cells, up to but excluding
+//the parenthesis which closes the DELAYFILE.
+//
+//Returns false if the text does not have the expected structure (e.g. it
+//has unbalanced parentheses, or no cells). Such files should be parsed
+//serially, which also produces the appropriate errors.
+bool split_sdf_cells(const char* begin, const char* end,
+                     size_t num_chunks, size_t num_threads,
+                     TextChunk& header, std::vector<TextChunk>& cell_chunks);
+
+//A top-level CELL definition found by scan_sdf_cells()
+struct CellText {
+    TextChunk text; //From the CELL's opening parenthesis to its closing one (inclusive)
+
+    //The raw (still escaped) text of the CELLTYPE's quoted string (without
+    //quotes) and of the INSTANCE's identifier. These are null if the cell
+    //does not begin in the usual '(CELL (CELLTYPE "...") (INSTANCE ...)' form.
+    const char* celltype_begin = nullptr;
+    const char* celltype_end = nullptr;
+    const char* instance_begin = nullptr;
+    const char* instance_end = nullptr;
+};
+
+//Scans the SDF text in [begin, end) for its top-level CELL definitions,
+//calling on_cell for each (in file order), without otherwise parsing them.
+//
+//On success, header covers everything from the start of the file up to
+//the first CELL (or the parenthesis which closes the DELAYFILE if there are
+//none). Returns false if the text does not have the expected structure
+//(as for split_sdf_cells()).
+bool scan_sdf_cells(const char* begin, const char* end, TextChunk& header,
+                    const std::function<void(const CellText&)>& on_cell);
+
+//Returns the column of p within the text starting at begin, as counted by the lexers
+unsigned text_column(const char* begin, const char* p);
+
+} //sdfparse
@@ -0,0 +1,263 @@
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+#include "sdf_corners.hpp"
+#include "sdf_hash_map.hpp"
+
+namespace /*anonymous*/ {
+
+using sdfparse::TripleColumns;
+using sdfparse::TripleValue;
+
+const std::vector<double>& select(const TripleColumns& columns, TripleValue value);
+std::vector<double>& select(TripleColumns& columns, TripleValue value);
+void reset_columns(TripleColumns& columns, size_t num_values);
+void max_into(std::vector<double>& result, const std::vector<double>& values);
+void min_into(std::vector<double>& result, const std::vector<double>& values);
+void scale_values(std::vector<double>& values, double factor);
+bool same_port(const sdfparse::PortSpec& lhs, const sdfparse::PortSpec& rhs);
+
+const std::vector<double>& select(const TripleColumns& columns, TripleValue value) {
+    switch(value) {
+        case TripleValue::MIN: return columns.min;
+        case TripleValue::TYP: return columns.typ;
+        case TripleValue::MAX: //Fall through
+        default: return columns.max;
+    }
+}
+
+std::vector<double>& select(TripleColumns& columns, TripleValue value) {
+    return const_cast<std::vector<double>&>(select(static_cast<const TripleColumns&>(columns), value));
+}
+
+//Makes columns hold num_values empty (NaN) values
+void reset_columns(TripleColumns& columns, size_t num_values) {
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    columns.min.assign(num_values, nan);
+    columns.typ.assign(num_values, nan);
+    columns.max.assign(num_values, nan);
+}
+
+//The kernels below are written as branch-free loops over contiguous
+//arrays, so they are vectorized (with compares and blends). NaN (empty)
+//values never compare greater or less, so are replaced by any other value.
+
+void max_into(std::vector<double>& result, const std::vector<double>& values) {
+    assert(result.size() == values.size());
+    double* out = result.data();
+    const double* in = values.data();
+    for(size_t i = 0, n = result.size(); i < n; ++i) {
+        out[i] = (in[i] > out[i] || out[i] != out[i]) ? in[i] : out[i];
+    }
+}
+
+void min_into(std::vector<double>& result, const std::vector<double>& values) {
+    assert(result.size() == values.size());
+    double* out = result.data();
+    const double* in = values.data();
+    for(size_t i = 0, n = result.size(); i < n; ++i) {
+        out[i] = (in[i] < out[i] || out[i] != out[i]) ? in[i] : out[i];
+    }
+}
+
+void scale_values(std::vector<double>& values, double factor) {
+    double* data = values.data();
+    for(size_t i = 0, n = values.size(); i < n; ++i) {
+        data[i] *= factor;
+    }
+}
+
+//Whether the ports (which may be from different symbol tables) are the same
+bool same_port(const sdfparse::PortSpec& lhs, const sdfparse::PortSpec& rhs) {
+    return lhs.condition() == rhs.condition() && lhs.port() == rhs.port();
+}
+
+} //namespace
+
+namespace sdfparse {
+
+constexpr size_t CornerDelayFile::ALL_CORNERS;
+
+CornerDelayFile::CornerDelayFile(const std::vector<DelayFile>& corners, std::vector<std::string> corner_names)
+    : CornerDelayFile() {
+    assert(corners.size() == corner_names.size());
+    if(corners.empty()) return;
+
+    corner_names_ = std::move(corner_names);
+    rise_.resize(corners.size());
+    fall_.resize(corners.size());
+    timing_t_.resize(corners.size());
+
+    add_first_corner(corners[0]);
+
+    const Timescale& timescale = header_.timescale();
+    for(size_t corner = 1; corner < corners.size(); ++corner) {
+        const Timescale& corner_timescale = corners[corner].header().timescale();
+        if(corner_timescale.value() != timescale.value() || corner_timescale.unit() != timescale.unit()) {
+            throw std::runtime_error("TIMESCALE of corner '" + corner_names_[corner]
+                                     + "' differs from that of corner '" + corner_names_[0] + "'");
+        }
+        add_corner(corner, corners[corner]);
+    }
+}
+
+size_t CornerDelayFile::find_corner(const std::string& name) const {
+    for(size_t corner = 0; corner < corner_names_.size(); ++corner) {
+        if(corner_names_[corner] == name) {
+            return corner;
+        }
+    }
+    return ALL_CORNERS;
+}
+
+const TripleColumns& CornerDelayFile::values(size_t corner, CornerValues which) const {
+    assert(corner < num_corners());
+    switch(which) {
+        case CornerValues::RISE: return rise_[corner];
+        case CornerValues::FALL: return fall_[corner];
+        case CornerValues::TIMING: //Fall through
+        default: return timing_t_[corner];
+    }
+}
+
+TripleColumns& CornerDelayFile::mutable_values(size_t corner, CornerValues which) {
+    return const_cast<TripleColumns&>(values(corner, which));
+}
+
+std::vector<double> CornerDelayFile::max_across_corners(CornerValues which, TripleValue value) const {
+    if(num_corners() == 0) return std::vector<double>();
+
+    std::vector<double> result = select(values(0, which), value);
+    for(size_t corner = 1; corner < num_corners(); ++corner) {
+        max_into(result, select(values(corner, which), value));
+    }
+    return result;
+}
+
+std::vector<double> CornerDelayFile::min_across_corners(CornerValues which, TripleValue value) const {
+    if(num_corners() == 0) return std::vector<double>();
+
+    std::vector<double> result = select(values(0, which), value);
+    for(size_t corner = 1; corner < num_corners(); ++corner) {
+        min_into(result, select(values(corner, which), value));
+    }
+    return result;
+}
+
+void CornerDelayFile::scale(TripleValue value, double factor, size_t corner) {
+    for(size_t icorner = 0; icorner < num_corners(); ++icorner) {
+        if(corner != ALL_CORNERS && icorner != corner) continue;
+
+        for(CornerValues which : {CornerValues::RISE, CornerValues::FALL, CornerValues::TIMING}) {
+            scale_values(select(mutable_values(icorner, which), value), factor);
+        }
+    }
+}
+
+void CornerDelayFile::add_first_corner(const DelayFile& delayfile) {
+    header_ = delayfile.header();
+    symbols_ = delayfile.shared_symbols();
+
+    FlatSizes sizes = reserve_structure(delayfile);
+    rise_[0].reserve(sizes.num_iopaths);
+    fall_[0].reserve(sizes.num_iopaths);
+    timing_t_[0].reserve(sizes.num_timings);
+
+    for(const Cell& cell : delayfile.cells()) {
+        for(const Iopath& iopath : cell.delay().iopaths()) {
+            rise_[0].push_back(iopath.rise());
+            fall_[0].push_back(iopath.fall());
+        }
+        for(const Timing& timing : cell.timing_check().timing()) {
+            timing_t_[0].push_back(timing.t());
+        }
+        add_structure(cell, cell.instance_symbol());
+    }
+}
+
+void CornerDelayFile::add_corner(size_t corner, const DelayFile& delayfile) {
+    reset_columns(rise_[corner], num_iopaths());
+    reset_columns(fall_[corner], num_iopaths());
+    reset_columns(timing_t_[corner], num_timings());
+
+    auto mismatch = [&](const std::string& what, const Cell& cell) {
+        return std::runtime_error(what + " of instance '" + cell.instance() + "' in corner '"
+                                  + corner_names_[corner] + "' is not in corner '" + corner_names_[0] + "'");
+    };
+
+    //Built if the corner's cells are not in the same order
+    OpenHashMap<Symbol, size_t> cell_index;
+
+    const std::vector<Cell>& cells = delayfile.cells();
+    for(size_t i = 0; i < cells.size(); ++i) {
+        const Cell& cell = cells[i];
+
+        size_t icell = i;
+        if(i >= num_cells() || instances_[i].str() != cell.instance()) {
+            if(cell_index.empty()) {
+                cell_index.reserve(num_cells());
+                for(size_t j = 0; j < num_cells(); ++j) {
+                    cell_index.insert(instances_[j], j);
+                }
+            }
+            Symbol instance = symbols_->find(cell.instance());
+            const size_t* found = instance.is_null() ? nullptr : cell_index.find(instance);
+            if(!found) {
+                throw mismatch("Cell", cell);
+            }
+            icell = *found;
+        }
+
+        //Each arc is expected at the same position within the cell
+        ArrayView<Iopath> iopaths = cell.delay().iopaths();
+        for(size_t j = 0; j < iopaths.size(); ++j) {
+            const Iopath& iopath = iopaths[j];
+            auto matches = [&](size_t k) {
+                return same_port(iopath_inputs_[k], iopath.input()) && same_port(iopath_outputs_[k], iopath.output());
+            };
+
+            size_t k = iopath_begin(icell) + j;
+            if(k >= iopath_end(icell) || !matches(k)) {
+                k = iopath_begin(icell);
+                while(k < iopath_end(icell) && !matches(k)) {
+                    ++k;
+                }
+                if(k == iopath_end(icell)) {
+                    throw mismatch("IOPATH " + iopath.input().port() + " " + iopath.output().port(), cell);
+                }
+            }
+            rise_[corner].min[k] = iopath.rise().min();
+            rise_[corner].typ[k] = iopath.rise().typ();
+            rise_[corner].max[k] = iopath.rise().max();
+            fall_[corner].min[k] = iopath.fall().min();
+            fall_[corner].typ[k] = iopath.fall().typ();
+            fall_[corner].max[k] = iopath.fall().max();
+        }
+
+        ArrayView<Timing> timings = cell.timing_check().timing();
+        for(size_t j = 0; j < timings.size(); ++j) {
+            const Timing& timing = timings[j];
+            auto matches = [&](size_t k) {
+                return timing_types_[k] == timing.timing_type()
+                       && same_port(timing_clocks_[k], timing.clock()) && same_port(timing_ports_[k], timing.port());
+            };
+
+            size_t k = timing_begin(icell) + j;
+            if(k >= timing_end(icell) || !matches(k)) {
+                k = timing_begin(icell);
+                while(k < timing_end(icell) && !matches(k)) {
+                    ++k;
+                }
+                if(k == timing_end(icell)) {
+                    throw mismatch(timing.type() + " check", cell);
+                }
+            }
+            timing_t_[corner].min[k] = timing.t().min();
+            timing_t_[corner].typ[k] = timing.t().typ();
+            timing_t_[corner].max[k] = timing.t().max();
+        }
+    }
+}
+
+} //sdfparse
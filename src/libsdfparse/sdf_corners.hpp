@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_flat.hpp"
+
+namespace sdfparse {
+
+//Selects a set of values stored for each corner
+enum class CornerValues {
+    RISE,  //IOPATH rise delays
+    FALL,  //IOPATH fall delays
+    TIMING //Timing check values
+};
+
+//The delays of one netlist at several corners (e.g. ss/tt/ff)
+//
+//The structure (cells, IOPATHs and timing checks, see FlatStructure) and
+//names are stored once, and the values of each corner are stored column-wise
+//(e.g. values(corner, CornerValues::RISE).max holds the maximum rise delay
+//of every IOPATH at that corner). So N corners take little more memory than
+//N sets of values, and the bulk operations below (e.g. the worst case across
+//corners, or derating) are simple loops over contiguous arrays, which the
+//compiler vectorizes.
+//
+//The corners are typically loaded together with a BatchLoader, after which
+//their DelayFiles can be released.
+class CornerDelayFile : public FlatStructure {
+    public:
+        static constexpr size_t ALL_CORNERS = size_t(-1);
+
+        CornerDelayFile() = default;
+
+        //Merges the corners, whose structure is taken from the first. The
+        //other corners must contain the same (or a subset of its) cells,
+        //IOPATHs and timing checks, which are matched by instance and ports
+        //(quickly if they are in the same order); values missing from a
+        //corner are empty (NaN). Throws std::runtime_error if the corners do
+        //not match, or their TIMESCALEs differ.
+        CornerDelayFile(const std::vector<DelayFile>& corners, std::vector<std::string> corner_names);
+
+        //Corners
+        size_t num_corners() const { return corner_names_.size(); }
+        const std::string& corner_name(size_t corner) const { return corner_names_[corner]; }
+
+        //Returns the corner's index, or ALL_CORNERS if there is no such corner
+        size_t find_corner(const std::string& name) const;
+
+        //Values (indexed by IOPATH or timing check)
+        const TripleColumns& values(size_t corner, CornerValues which) const;
+        const TripleColumns& rise(size_t corner) const { return values(corner, CornerValues::RISE); }
+        const TripleColumns& fall(size_t corner) const { return values(corner, CornerValues::FALL); }
+        const TripleColumns& timing_t(size_t corner) const { return values(corner, CornerValues::TIMING); }
+
+        //Returns the largest (or smallest) of the selected value across the
+        //corners, for each IOPATH (or timing check). Empty values are ignored,
+        //and the result is empty (NaN) only if the value is empty at every corner.
+        std::vector<double> max_across_corners(CornerValues which, TripleValue value) const;
+        std::vector<double> min_across_corners(CornerValues which, TripleValue value) const;
+
+        //Multiplies the selected value of every IOPATH and timing check at
+        //the corner (or at every corner) by factor, e.g. to apply a derate
+        void scale(TripleValue value, double factor, size_t corner=ALL_CORNERS);
+
+    private:
+        TripleColumns& mutable_values(size_t corner, CornerValues which);
+
+        //Adds the structure and values of the first corner
+        void add_first_corner(const DelayFile& delayfile);
+
+        //Adds the values of another corner
+        void add_corner(size_t corner, const DelayFile& delayfile);
+
+    private:
+        std::vector<std::string> corner_names_;
+
+        //Values of each corner
+        std::vector<TripleColumns> rise_;
+        std::vector<TripleColumns> fall_;
+        std::vector<TripleColumns> timing_t_;
+};
+
+} //sdfparse
@@ -1,77 +1,192 @@
 #include "sdf_data.hpp"
 #include "sdf_escape.hpp"
+#include "sdf_index.hpp"
+#include "sdf_writer.hpp"
+#include <cassert>
+#include <functional>
 #include <iostream>
 #include <cmath>
 
 namespace /*anonymous*/ {
-    std::string ident(int depth);
+    const std::string& timing_type_name(sdfparse::TimingType type);
 
-    std::string ident(int depth) {
-        return std::string(2*depth, ' ');
+    const std::string& timing_type_name(sdfparse::TimingType type) {
+        //Indexed by TimingType
+        static const std::string type_names[] = {"SETUP", "HOLD", "RECOVERY", "REMOVAL"};
+        return type_names[static_cast<size_t>(type)];
     }
 }
 namespace sdfparse {
 
 
-    void DelayFile::print(std::ostream& os, int depth) const {
-        os << ident(depth) << "(DELAYFILE\n";
+    DelayFile::DelayFile(Header new_header, std::vector<Cell> new_cells,
+                         std::shared_ptr<SymbolTable> new_symbols, std::shared_ptr<Arena> new_arena)
+        : header_(std::move(new_header))
+        , cells_(std::move(new_cells))
+        , symbols_(std::move(new_symbols))
+        , arena_(std::move(new_arena))
+        , index_(std::make_shared<DelayFileIndex>())
+        {}
+
+    DelayFile::DelayFile(const DelayFile& other)
+        : header_(other.header_)
+        , cells_(other.cells_)
+        , symbols_(other.symbols_)
+        , arena_(other.arena_)
+        , lists_in_arena_(other.lists_in_arena_)
+        , index_(std::make_shared<DelayFileIndex>())
+        {}
+
+    DelayFile& DelayFile::operator=(const DelayFile& other) {
+        if(this != &other) {
+            header_ = other.header_;
+            cells_ = other.cells_;
+            symbols_ = other.symbols_;
+            arena_ = other.arena_;
+            lists_in_arena_ = other.lists_in_arena_;
+            index_ = std::make_shared<DelayFileIndex>();
+        }
+        return *this;
+    }
+
+    DelayFile DelayFile::clone(CellStorage storage) const {
+        auto arena = std::make_shared<Arena>();
+        std::vector<Cell> cells;
+        cells.reserve(cells_.size());
+        for(const Cell& cell : cells_) {
+            cells.push_back(copy_cell(cell, cell.instance_symbol(), storage, *arena));
+        }
+        return DelayFile(header_, std::move(cells), symbols_, std::move(arena));
+    }
+
+    void DelayFile::make_lists_writable() {
+        //Lists in an arena no copy of this file shares are already writable
+        if(lists_in_arena_ && arena_.use_count() == 1) {
+            return;
+        }
+
+        auto arena = std::make_shared<Arena>();
+        for(Cell& cell : cells_) {
+            cell.make_lists_writable(*arena);
+        }
+        arena_ = std::move(arena);
+        lists_in_arena_ = true;
 
-        header().print(os, depth+1);
+        //The index refers to the previous lists
+        index_ = std::make_shared<DelayFileIndex>();
+    }
+
+    MutableArrayView<Iopath> DelayFile::mutable_iopaths(size_t icell) {
+        make_lists_writable();
+        return cells_[icell].mutable_iopaths();
+    }
+
+    MutableArrayView<Timing> DelayFile::mutable_timing(size_t icell) {
+        make_lists_writable();
+        return cells_[icell].mutable_timing();
+    }
+
+    const Cell* DelayFile::find_cell(const std::string& instance) const {
+        build_index();
+        size_t icell = index_->find_cell(instance);
+        return (icell != DelayFileIndex::NO_CELL) ? &cells_[icell] : nullptr;
+    }
+
+    const Cell* DelayFile::find_cell(const std::vector<std::string>& instance_path) const {
+        std::string instance;
+        for(size_t i = 0; i < instance_path.size(); ++i) {
+            if(i > 0) {
+                instance += header_.divider();
+            }
+            instance += instance_path[i];
+        }
+        return find_cell(instance);
+    }
 
-        for(auto& cell : cells()) {
-            cell.print(os, depth+1);
+    const Iopath* DelayFile::find_iopath(const Cell& cell, const std::string& input, const std::string& output,
+                                         PortCondition condition) const {
+        build_index();
+        //Cells which are not elements of cells_ are looked up by instance
+        std::less<const Cell*> before;
+        size_t icell = (!before(&cell, cells_.data()) && before(&cell, cells_.data() + cells_.size()))
+                       ? static_cast<size_t>(&cell - cells_.data())
+                       : index_->find_cell(cell.instance());
+        if(icell == DelayFileIndex::NO_CELL) {
+            return nullptr;
         }
-        os << ident(depth) << ")\n";
-        
+        return index_->find_iopath(icell, input, output, condition);
+    }
+
+    void DelayFile::build_index() const {
+        index_->build(*this);
+    }
+
+    void DelayFile::print(std::ostream& os, int depth) const {
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     void Header::print(std::ostream& os, int depth) const {
-        os << ident(depth) << "(SDFVERSION \"" << sdfversion() << "\")\n";
-        os << ident(depth) << "(DESIGN \"" << design() << "\")\n";
-        os << ident(depth) << "(VENDOR \"" << vendor() << "\")\n";
-        os << ident(depth) << "(PROGRAM \"" << program() << "\")\n";
-        os << ident(depth) << "(VERSION \"" << version() << "\")\n";
-        os << ident(depth) << "(DIVIDER " << divider() << ")\n";
-        timescale().print(os, depth);
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     void Timescale::print(std::ostream& os, int depth) const {
-        os << ident(depth) << "(TIMESCALE " << value() << " " << unit() << ")\n";
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     void Cell::print(std::ostream& os, int depth) const {
-        os << ident(depth) << "(CELL\n";
-        os << ident(depth+1) << "(CELLTYPE \"" << escape_sdf_identifier(celltype()) << "\")\n";
-        os << ident(depth+1) << "(INSTANCE " << escape_sdf_identifier(instance()) << ")\n";
-        delay().print(os, depth+1);
-        timing_check().print(os, depth+1);
-        os << ident(depth) << ")\n";
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     void Delay::print(std::ostream& os, int depth) const {
-        if(!iopaths_.empty()) {
-            os << ident(depth) << "(DELAY\n";
-            os << ident(depth+1) << "(" << type() << "\n";
-            for(auto& iopath : iopaths()) {
-                iopath.print(os, depth+2);
-            }
-            os << ident(depth+1) << ")\n";
-            os << ident(depth) << ")\n";
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
+    }
+
+    const std::string& Timing::type() const {
+        return timing_type_name(type_);
+    }
+
+    void Cell::make_lists_writable(Arena& arena) {
+        NodeList<Iopath>& iopaths = delay_.iopaths_;
+        if(!iopaths.owns_elements()) {
+            iopaths = NodeList<Iopath>::writable_view(arena.copy(iopaths.view()));
+        }
+        NodeList<Timing>& timing_checks = timing_check_.timing_checks_;
+        if(!timing_checks.owns_elements()) {
+            timing_checks = NodeList<Timing>::writable_view(arena.copy(timing_checks.view()));
+        }
+    }
+
+    Cell copy_cell(const Cell& cell, Symbol instance, CellStorage storage, Arena& arena) {
+        ArrayView<Iopath> iopaths = cell.delay().iopaths();
+        ArrayView<Timing> timing_checks = cell.timing_check().timing();
+        if(storage == CellStorage::ARENA) {
+            return Cell(cell.celltype_symbol(), instance,
+                        Delay(cell.delay().type(), arena.copy(iopaths)),
+                        TimingCheck(arena.copy(timing_checks)));
         }
+        return Cell(cell.celltype_symbol(), instance,
+                    Delay(cell.delay().type(), NodeList<Iopath>::copy_of(iopaths)),
+                    TimingCheck(NodeList<Timing>::copy_of(timing_checks)));
+    }
+
+    std::ostream& operator<<(std::ostream& os, const TimingType& val) {
+        os << timing_type_name(val);
+        return os;
     }
 
     void Timing::print(std::ostream& os, int depth) const {
-        os << ident(depth) << type() << port() << " " << clock() << " " << t() << ")\n";
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     void TimingCheck::print(std::ostream& os, int depth) const {
-        if(!timing().empty()) {
-            os << ident(depth) << "(TIMINGCHECK\n";
-            for(auto& timing_check : timing()) {
-                timing_check.print(os, depth+1);
-            }
-            os << ident(depth) << ")\n";
-        }
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     std::ostream& operator<<(std::ostream& os, const Delay::Type& type) {
@@ -84,7 +199,8 @@ namespace sdfparse {
     }
 
     void Iopath::print(std::ostream& os, int depth) const {
-        os << ident(depth) << "(IOPATH " << input() << " " << output() << " " << rise() << " " << fall() << ")\n";
+        Writer writer(os, WriteFormat::COMPATIBLE);
+        writer.write(*this, depth);
     }
 
     std::ostream& operator<<(std::ostream& os, const RealTriple& val) {
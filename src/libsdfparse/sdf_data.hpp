@@ -2,17 +2,31 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <memory>
 #include <limits>
 #include <iosfwd>
 #include <cassert>
 
 #include "sdf_data_fwd.hpp"
+#include "sdf_symbol.hpp"
+#include "sdf_array_view.hpp"
+#include "sdf_arena.hpp"
+#include "sdf_node_list.hpp"
 
 //The classes defined in this file correspond (almost directly) to the 
 //structures in the SDF file.
 //
 //The key exception is that for simplicity some basic structures (e.g. CELLTYPE, INSTANCE)
 //have been folded into thier parents (e.g. CELL) as attributes.
+//
+//Names (e.g. cell types, instances and ports) are stored as Symbols
+//interned in the DelayFile's SymbolTable, so repeated names are stored
+//once, and comparing names is a pointer comparison.
+//
+//Lists (e.g. of IOPATHs) are NodeLists, which either own their elements
+//or refer to storage in the DelayFile's Arena (see CellStorage), and are
+//accessed as ArrayViews.
 
 namespace sdfparse {
 
@@ -61,16 +75,17 @@ namespace sdfparse {
     class PortSpec {
         public:
             PortSpec() = default;
-            PortSpec(std::string port_name, PortCondition port_condition)
+            PortSpec(Symbol port_name, PortCondition port_condition)
                 : port_(port_name)
                 , condition_(port_condition)
                 {}
 
-            std::string port() const { return port_; }
+            const std::string& port() const { return port_.str(); }
+            Symbol port_symbol() const { return port_; }
             PortCondition condition() const { return condition_; }
 
         private:
-            std::string port_;
+            Symbol port_;
             PortCondition condition_;
     };
     std::ostream& operator<<(std::ostream& os, const PortSpec& val);
@@ -84,8 +99,8 @@ namespace sdfparse {
         public:
             Iopath() = default;
             Iopath(PortSpec new_input, PortSpec new_output, RealTriple new_rise, RealTriple new_fall)
-                : input_(new_input)
-                , output_(new_output)
+                : input_(std::move(new_input))
+                , output_(std::move(new_output))
                 , rise_(new_rise)
                 , fall_(new_fall)
                 {}
@@ -95,6 +110,9 @@ namespace sdfparse {
             const RealTriple& rise() const { return rise_; }
             const RealTriple& fall() const { return fall_; }
 
+            void set_rise(const RealTriple& value) { rise_ = value; }
+            void set_fall(const RealTriple& value) { fall_ = value; }
+
             void print(std::ostream& os, int depth=0) const;
         private:
             PortSpec input_;
@@ -103,34 +121,45 @@ namespace sdfparse {
             RealTriple fall_;
     };
 
+    enum class TimingType {
+        SETUP,
+        HOLD,
+        RECOVERY,
+        REMOVAL
+    };
+    std::ostream& operator<<(std::ostream& os, const TimingType& val);
+
     class Timing {
         public:
             Timing() = default;
-            Timing(PortSpec clock_spec, PortSpec port_spec, RealTriple value, const std::string& type)
-                : clock_(clock_spec)
-                , port_(port_spec)
+            Timing(PortSpec clock_spec, PortSpec port_spec, RealTriple value, TimingType timing_type)
+                : clock_(std::move(clock_spec))
+                , port_(std::move(port_spec))
                 , t_(value)
-                , type_(type)
+                , type_(timing_type)
                 {}
 
             const PortSpec& clock() const { return clock_; }
             const PortSpec& port() const { return port_; }
             RealTriple t() const { return t_; }
-            const std::string& type() const { return type_; }
+            const std::string& type() const; //e.g. "SETUP"
+            TimingType timing_type() const { return type_; }
+
+            void set_t(const RealTriple& value) { t_ = value; }
 
             void print(std::ostream& os, int depth=0) const;
         private:
             PortSpec clock_;
             PortSpec port_;
             RealTriple t_;
-            std::string type_;
+            TimingType type_;
     };
 
     class Setup: public Timing {
         public:
             Setup() = default;
             Setup(PortSpec clock_spec, PortSpec port_spec, RealTriple value) :
-                Timing(clock_spec, port_spec, value, "SETUP")
+                Timing(clock_spec, port_spec, value, TimingType::SETUP)
             {}
     };
 
@@ -138,7 +167,7 @@ namespace sdfparse {
         public:
             Hold() = default;
             Hold(PortSpec clock_spec, PortSpec port_spec, RealTriple value) :
-                Timing(clock_spec, port_spec, value, "HOLD")
+                Timing(clock_spec, port_spec, value, TimingType::HOLD)
             {}
     };
 
@@ -146,7 +175,7 @@ namespace sdfparse {
         public:
             Recovery() = default;
             Recovery(PortSpec clock_spec, PortSpec port_spec, RealTriple value) :
-                Timing(clock_spec, port_spec, value, "RECOVERY")
+                Timing(clock_spec, port_spec, value, TimingType::RECOVERY)
             {}
     };
 
@@ -154,22 +183,33 @@ namespace sdfparse {
         public:
             Removal() = default;
             Removal(PortSpec clock_spec, PortSpec port_spec, RealTriple value) :
-                Timing(clock_spec, port_spec, value, "REMOVAL")
+                Timing(clock_spec, port_spec, value, TimingType::REMOVAL)
             {}
     };
 
     class TimingCheck {
         public:
             TimingCheck() = default;
-            TimingCheck(std::vector<Timing> timing_checks_vec)
-                : timing_checks_(timing_checks_vec)
+            //Refers to the timing checks, which must outlive it
+            TimingCheck(ArrayView<Timing> timing_checks_view)
+                : timing_checks_(timing_checks_view)
+                {}
+            //Owns a copy of the timing checks
+            TimingCheck(const std::vector<Timing>& timing_checks_value)
+                : timing_checks_(timing_checks_value)
+                {}
+            TimingCheck(NodeList<Timing> timing_checks_list)
+                : timing_checks_(std::move(timing_checks_list))
                 {}
 
-            std::vector<Timing> timing() const { return timing_checks_; }
+            ArrayView<Timing> timing() const { return timing_checks_.view(); }
+            bool owns_timing() const { return timing_checks_.owns_elements(); }
 
             void print(std::ostream& os, int depth=0) const;
         private:
-            std::vector<Timing> timing_checks_;
+            friend class Cell;
+
+            NodeList<Timing> timing_checks_;
     };
 
     //A Delay declaration
@@ -182,47 +222,88 @@ namespace sdfparse {
             };
 
             Delay() = default;
-            Delay(Delay::Type new_type, std::vector<Iopath> new_iopaths)
+            //Refers to the IOPATHs, which must outlive it
+            Delay(Delay::Type new_type, ArrayView<Iopath> new_iopaths)
+                : type_(new_type)
+                , iopaths_(new_iopaths)
+                {}
+            //Owns a copy of the IOPATHs
+            Delay(Delay::Type new_type, const std::vector<Iopath>& new_iopaths)
                 : type_(new_type)
                 , iopaths_(new_iopaths)
                 {}
+            Delay(Delay::Type new_type, NodeList<Iopath> new_iopaths)
+                : type_(new_type)
+                , iopaths_(std::move(new_iopaths))
+                {}
 
             Delay::Type type() const { return type_; }
-            const std::vector<Iopath>& iopaths() const { return iopaths_; }
+            ArrayView<Iopath> iopaths() const { return iopaths_.view(); }
+            bool owns_iopaths() const { return iopaths_.owns_elements(); }
 
             void print(std::ostream& os, int depth=0) const;
         private:
-            Delay::Type type_;
-            std::vector<Iopath> iopaths_;
+            friend class Cell;
+
+            Delay::Type type_ = Delay::Type::ABSOLUTE;
+            NodeList<Iopath> iopaths_;
     };
     std::ostream& operator<<(std::ostream& os, const Delay::Type& type);
 
     //A CELL definition
     //
     //It consists of a celltype(), instance() and delay()
+    //
+    //Copies of a cell whose lists do not own their elements (see
+    //CellStorage::ARENA) refer to the same elements, so must not outlive
+    //their storage (e.g. the DelayFile they were copied from).
     class Cell {
         public:
             Cell() = default;
-            Cell(const std::string& new_celltype, const std::string& new_instance, Delay new_delay, TimingCheck timing_check_value)
+            Cell(Symbol new_celltype, Symbol new_instance, Delay new_delay, TimingCheck timing_check_value)
                 : celltype_(new_celltype)
                 , instance_(new_instance)
-                , delay_(new_delay)
-                , timing_check_(timing_check_value)
+                , delay_(std::move(new_delay))
+                , timing_check_(std::move(timing_check_value))
                 {}
 
-                const std::string& celltype() const { return celltype_; }
-                const std::string& instance() const { return instance_; }
+                const std::string& celltype() const { return celltype_.str(); }
+                const std::string& instance() const { return instance_.str(); }
+                Symbol celltype_symbol() const { return celltype_; }
+                Symbol instance_symbol() const { return instance_; }
                 const Delay& delay() const { return delay_; }
                 const TimingCheck& timing_check() const { return timing_check_; }
 
                 void print(std::ostream& os, int depth=0) const;
         private:
-            std::string celltype_;
-            std::string instance_;
+            friend class DelayFile;
+
+            //Copies any lists which the cell does not own into arena, where
+            //they may be modified
+            void make_lists_writable(Arena& arena);
+
+            MutableArrayView<Iopath> mutable_iopaths() { return delay_.iopaths_.mutable_view(); }
+            MutableArrayView<Timing> mutable_timing() { return timing_check_.timing_checks_.mutable_view(); }
+
+        private:
+            Symbol celltype_;
+            Symbol instance_;
             Delay delay_;
             TimingCheck timing_check_;
     };
 
+    //How the IOPATH and timing check lists of cells are stored
+    enum class CellStorage {
+        HEAP, //Each list is a separate allocation owned by its Delay or TimingCheck,
+              //so cells are independent values (as are copies of the DelayFile)
+        ARENA //Lists are stored in the DelayFile's arena(), which is faster to build
+              //and to free, but copies of cells (and of the DelayFile) share them
+    };
+
+    //Returns a copy of cell, named instance, whose lists are stored as
+    //specified (in arena if CellStorage::ARENA)
+    Cell copy_cell(const Cell& cell, Symbol instance, CellStorage storage, Arena& arena);
+
     //A TIMESCALE definition
     //
     //It has a value() and unit()
@@ -284,19 +365,82 @@ namespace sdfparse {
     //This contains all the data included in the parsed SDF file.
     //
     //Organized as a header(), and list of cells().
+    //
+    //The names used by the cells are interned in symbols(), which is shared
+    //by copies of the DelayFile. Their IOPATHs and timing checks are either
+    //owned by the cells, or stored in arena() (which is also shared by
+    //copies); see CellStorage. clone() makes a copy with its own storage.
+    //
+    //The IOPATH and timing check values can be modified in place through
+    //mutable_iopaths() and mutable_timing(). Lists the file does not have
+    //to itself (those in an arena shared with its copies, or stored
+    //elsewhere) are first copied into a new arena (see make_lists_writable()),
+    //so modifying a file never affects its copies.
+    //
+    //Cells and IOPATHs can be looked up by name with find_cell() and
+    //find_iopath(). These use a hash index which is built (thread-safely)
+    //on first use, or explicitly with build_index(); once it is built,
+    //lookups take no locks.
     class DelayFile {
         public:
-            DelayFile(const Header& new_header=Header(), const std::vector<Cell>& new_cells=std::vector<Cell>())
-                : header_(new_header)
-                , cells_(new_cells)
-                {}
+            DelayFile(Header new_header=Header(), std::vector<Cell> new_cells=std::vector<Cell>(),
+                      std::shared_ptr<SymbolTable> new_symbols=std::make_shared<SymbolTable>(),
+                      std::shared_ptr<Arena> new_arena=std::make_shared<Arena>());
+
+            //Copies share the names and any arena storage, but not the index
+            //(which refers to the lists of the cells it was built for)
+            DelayFile(const DelayFile& other);
+            DelayFile(DelayFile&& other) = default;
+            DelayFile& operator=(const DelayFile& other);
+            DelayFile& operator=(DelayFile&& other) = default;
+
+            //Returns a copy whose lists are stored (as specified) independently
+            //of this file's, so it remains valid if this file is destroyed
+            DelayFile clone(CellStorage storage=CellStorage::HEAP) const;
 
             const Header& header() const { return header_; }
             const std::vector<Cell>& cells() const { return cells_; }
+            const SymbolTable& symbols() const { return *symbols_; }
+            std::shared_ptr<const SymbolTable> shared_symbols() const { return symbols_; }
+            const Arena& arena() const { return *arena_; }
+
+            //Returns the (first) cell for the specified instance, or nullptr if there is none
+            const Cell* find_cell(const std::string& instance) const;
+
+            //As above, with the instance specified as the components of its
+            //hierarchical path (which are joined with the header's divider())
+            const Cell* find_cell(const std::vector<std::string>& instance_path) const;
+
+            //Returns the cell's IOPATH from input (with the specified edge condition)
+            //to output, or nullptr if there is none. The cell is usually one of
+            //cells(); otherwise (e.g. a copy of one) it is identified by its
+            //instance, as by find_cell(), and the IOPATH returned is this file's.
+            const Iopath* find_iopath(const Cell& cell, const std::string& input, const std::string& output,
+                                      PortCondition condition=PortCondition::NONE) const;
+
+            //Builds the lookup index used by find_cell() and find_iopath()
+            //(if not already built)
+            void build_index() const;
+
+            //Makes the lists of every cell writable by this file alone (if
+            //they are not already), copying those it does not own outright
+            //into a new arena. Copying invalidates references into the lists
+            //(e.g. from find_iopath()). Not thread-safe; call it before
+            //modifying the cells from several threads.
+            void make_lists_writable();
+
+            //The lists of cells()[icell], for modification in place (calls
+            //make_lists_writable())
+            MutableArrayView<Iopath> mutable_iopaths(size_t icell);
+            MutableArrayView<Timing> mutable_timing(size_t icell);
 
             void print(std::ostream& os, int depth=0) const;
         private:
             Header header_;
             std::vector<Cell> cells_;
+            std::shared_ptr<SymbolTable> symbols_;
+            std::shared_ptr<Arena> arena_;
+            bool lists_in_arena_ = false; //Whether the lists not owned by the cells are (writable) in arena_
+            std::shared_ptr<DelayFileIndex> index_; //Built lazily
     };
 }
@@ -6,4 +6,8 @@ namespace sdfparse {
     class Delay;
     class Iopath;
     class RealTriple;
+    class Symbol;
+    class SymbolTable;
+    class Arena;
+    class DelayFileIndex;
 }
@@ -0,0 +1,201 @@
+#include "sdf_decompress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if SDFPARSE_HAVE_ZLIB
+# include <zlib.h>
+#endif
+
+#if SDFPARSE_HAVE_ZSTD
+# include <zstd.h>
+#endif
+
+namespace /*anonymous*/ {
+
+const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+template<size_t N>
+bool has_magic(const char* data, size_t size, const unsigned char (&magic)[N]);
+
+template<size_t N>
+bool has_magic(const char* data, size_t size, const unsigned char (&magic)[N]) {
+    return size >= N && std::memcmp(data, magic, N) == 0;
+}
+
+#if SDFPARSE_HAVE_ZLIB
+
+//Decompresses a gzip file (including concatenated gzip members) with zlib
+class GzipSource : public sdfparse::ByteSource {
+    public:
+        explicit GzipSource(const std::string& filename)
+            : file_(gzopen(filename.c_str(), "rb")) {
+            if(!file_) {
+                throw std::runtime_error("Failed to open file");
+            }
+            gzbuffer(file_, INPUT_BUFFER_SIZE);
+        }
+
+        ~GzipSource() {
+            gzclose(file_);
+        }
+
+        GzipSource(const GzipSource&) = delete;
+        GzipSource& operator=(const GzipSource&) = delete;
+
+        size_t read(char* buf, size_t size) override {
+            //gzread() takes an unsigned length
+            unsigned len = static_cast<unsigned>(std::min<size_t>(size, 1u << 30));
+            int num_read = gzread(file_, buf, len);
+            if(num_read <= 0) {
+                //Reaching the end of the file mid-stream is reported as an error
+                int errnum = Z_OK;
+                const char* msg = gzerror(file_, &errnum);
+                if(num_read < 0 || (errnum != Z_OK && errnum != Z_STREAM_END)) {
+                    throw std::runtime_error(std::string("Failed to decompress gzip input: ") + msg);
+                }
+                return 0;
+            }
+            return num_read;
+        }
+
+    private:
+        static constexpr unsigned INPUT_BUFFER_SIZE = 256 << 10;
+
+        gzFile file_;
+};
+
+#endif
+
+#if SDFPARSE_HAVE_ZSTD
+
+//Decompresses a Zstandard file (including concatenated frames)
+class ZstdSource : public sdfparse::ByteSource {
+    public:
+        explicit ZstdSource(const std::string& filename)
+            : file_(std::fopen(filename.c_str(), "rb"))
+            , stream_(ZSTD_createDStream())
+            , input_buf_(new char[ZSTD_DStreamInSize()])
+            , input_buf_size_(ZSTD_DStreamInSize()) {
+            if(!file_ || !stream_) {
+                close();
+                throw std::runtime_error("Failed to open file");
+            }
+            ZSTD_initDStream(stream_);
+            input_ = {input_buf_.get(), 0, 0};
+        }
+
+        ~ZstdSource() {
+            close();
+        }
+
+        ZstdSource(const ZstdSource&) = delete;
+        ZstdSource& operator=(const ZstdSource&) = delete;
+
+        size_t read(char* buf, size_t size) override {
+            ZSTD_outBuffer output = {buf, size, 0};
+            while(output.pos == 0) {
+                if(input_.pos == input_.size && !flushing_) {
+                    size_t num_read = std::fread(input_buf_.get(), 1, input_buf_size_, file_);
+                    if(num_read == 0) {
+                        if(std::ferror(file_)) {
+                            throw std::runtime_error("Failed to read zstd input");
+                        }
+                        if(!frame_complete_) {
+                            throw std::runtime_error("Failed to decompress zstd input: unexpected end of file");
+                        }
+                        return 0;
+                    }
+                    input_ = {input_buf_.get(), num_read, 0};
+                }
+
+                size_t ret = ZSTD_decompressStream(stream_, &output, &input_);
+                if(ZSTD_isError(ret)) {
+                    throw std::runtime_error(std::string("Failed to decompress zstd input: ") + ZSTD_getErrorName(ret));
+                }
+                frame_complete_ = (ret == 0);
+
+                //If the output is full the decoder may be holding more data,
+                //which must be flushed before more input is needed
+                flushing_ = (output.pos == output.size);
+            }
+            return output.pos;
+        }
+
+    private:
+        void close() {
+            if(stream_) ZSTD_freeDStream(stream_);
+            if(file_) std::fclose(file_);
+            stream_ = nullptr;
+            file_ = nullptr;
+        }
+
+    private:
+        std::FILE* file_;
+        ZSTD_DStream* stream_;
+        std::unique_ptr<char[]> input_buf_;
+        size_t input_buf_size_;
+        ZSTD_inBuffer input_;
+        bool frame_complete_ = true; //Whether the input so far ends at a frame boundary
+        bool flushing_ = false;
+};
+
+#endif
+
+} //namespace
+
+namespace sdfparse {
+
+Compression detect_compression(const char* data, size_t size) {
+    if(has_magic(data, size, GZIP_MAGIC)) {
+        return Compression::GZIP;
+    } else if(has_magic(data, size, ZSTD_MAGIC)) {
+        return Compression::ZSTD;
+    }
+    return Compression::NONE;
+}
+
+Compression detect_compression(const std::string& filename) {
+    char magic[sizeof(ZSTD_MAGIC)];
+    std::ifstream is(filename, std::ios::binary);
+    is.read(magic, sizeof(magic));
+    return detect_compression(magic, is.gcount());
+}
+
+const char* compression_name(Compression compression) {
+    switch(compression) {
+        case Compression::GZIP: return "gzip";
+        case Compression::ZSTD: return "zstd";
+        case Compression::NONE: //Fall through
+        default: return "none";
+    }
+}
+
+bool compression_supported(Compression compression) {
+    switch(compression) {
+        case Compression::NONE: return true;
+        case Compression::GZIP: return SDFPARSE_HAVE_ZLIB;
+        case Compression::ZSTD: return SDFPARSE_HAVE_ZSTD;
+        default: return false;
+    }
+}
+
+std::unique_ptr<ByteSource> open_decompressor(const std::string& filename, Compression compression) {
+    switch(compression) {
+#if SDFPARSE_HAVE_ZLIB
+        case Compression::GZIP: return std::unique_ptr<ByteSource>(new GzipSource(filename));
+#endif
+#if SDFPARSE_HAVE_ZSTD
+        case Compression::ZSTD: return std::unique_ptr<ByteSource>(new ZstdSource(filename));
+#endif
+        default:
+            throw std::runtime_error(std::string("Reading ") + compression_name(compression)
+                                     + " compressed input is not supported by this build");
+    }
+}
+
+} //sdfparse
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "sdf_pipe.hpp"
+
+//Support for each compression format is enabled by the build system
+//when the corresponding library is found
+#ifndef SDFPARSE_HAVE_ZLIB
+# define SDFPARSE_HAVE_ZLIB 0
+#endif
+#ifndef SDFPARSE_HAVE_ZSTD
+# define SDFPARSE_HAVE_ZSTD 0
+#endif
+
+namespace sdfparse {
+
+enum class Compression {
+    NONE,
+    GZIP, //gzip (.gz)
+    ZSTD  //Zstandard (.zst)
+};
+
+//Returns the compression of the data, judged by its leading magic bytes
+Compression detect_compression(const char* data, size_t size);
+
+//Returns the compression of the file (NONE if it can not be read)
+Compression detect_compression(const std::string& filename);
+
+//Returns the name of the compression format
+const char* compression_name(Compression compression);
+
+//Returns true if this build can decompress the format
+bool compression_supported(Compression compression);
+
+//Returns a source of the file's decompressed contents.
+//Throws std::runtime_error if the file can not be opened or the format
+//is not supported.
+std::unique_ptr<ByteSource> open_decompressor(const std::string& filename, Compression compression);
+
+} //sdfparse
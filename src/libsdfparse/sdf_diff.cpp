@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+#include "sdf_diff.hpp"
+#include "sdf_fixed.hpp"
+#include "sdf_parallel.hpp"
+
+namespace /*anonymous*/ {
+
+//Number of cells compared by each parallel work item
+constexpr size_t CELLS_PER_BLOCK = 1024;
+
+bool same_ports(const sdfparse::PortSpec& lhs, const sdfparse::PortSpec& rhs);
+bool same_arc(const sdfparse::Iopath& lhs, const sdfparse::Iopath& rhs);
+bool same_arc(const sdfparse::Timing& lhs, const sdfparse::Timing& rhs);
+bool values_equal(double before, double after, const sdfparse::DiffOptions& options);
+const char* diff_symbol(sdfparse::DiffKind kind);
+
+//Compares the port names (which are from different SymbolTables) and conditions
+bool same_ports(const sdfparse::PortSpec& lhs, const sdfparse::PortSpec& rhs) {
+    return lhs.condition() == rhs.condition() && lhs.port() == rhs.port();
+}
+
+bool same_arc(const sdfparse::Iopath& lhs, const sdfparse::Iopath& rhs) {
+    //Matches DelayFile::find_iopath(), which ignores the output's condition
+    return lhs.input().condition() == rhs.input().condition()
+           && lhs.input().port() == rhs.input().port()
+           && lhs.output().port() == rhs.output().port();
+}
+
+bool same_arc(const sdfparse::Timing& lhs, const sdfparse::Timing& rhs) {
+    return lhs.timing_type() == rhs.timing_type()
+           && same_ports(lhs.port(), rhs.port())
+           && same_ports(lhs.clock(), rhs.clock());
+}
+
+bool values_equal(double before, double after, const sdfparse::DiffOptions& options) {
+    if(std::isnan(before) || std::isnan(after)) {
+        return std::isnan(before) && std::isnan(after);
+    }
+    double tolerance = std::max(options.abs_tolerance,
+                                options.rel_tolerance * std::max(std::fabs(before), std::fabs(after)));
+    return std::fabs(before - after) <= tolerance;
+}
+
+const char* diff_symbol(sdfparse::DiffKind kind) {
+    switch(kind) {
+        case sdfparse::DiffKind::ADDED: return "+";
+        case sdfparse::DiffKind::REMOVED: return "-";
+        case sdfparse::DiffKind::CHANGED: //Fall through
+        default: return "~";
+    }
+}
+
+} //namespace
+
+namespace sdfparse {
+
+struct DelayFileDiff::BlockResult {
+    std::vector<CellDiff> cells;
+    std::vector<IopathDiff> iopaths;
+    std::vector<TimingDiff> timing_checks;
+
+    size_t num_matched_cells = 0;
+    size_t num_compared_iopaths = 0;
+    size_t num_compared_timing_checks = 0;
+};
+
+DelayFileDiff::DelayFileDiff(const DelayFile& before, const DelayFile& after, const DiffOptions& options)
+    : options_(options)
+    , after_factor_(1.) {
+    const Timescale& before_timescale = before.header().timescale();
+    const Timescale& after_timescale = after.header().timescale();
+    if(before_timescale.value() != after_timescale.value() || before_timescale.unit() != after_timescale.unit()) {
+        after_factor_ = timescale_factor(after_timescale, FixedUnit::FS) / timescale_factor(before_timescale, FixedUnit::FS);
+    }
+
+    //Build the indexes up front, rather than on first use by the workers
+    before.build_index();
+    after.build_index();
+
+    //Work items are the blocks of the first file's cells (which find the
+    //removed cells, and the differences within matched cells), followed by
+    //those of the second's (which find the added cells)
+    const std::vector<Cell>& before_cells = before.cells();
+    const std::vector<Cell>& after_cells = after.cells();
+    size_t num_before_blocks = (before_cells.size() + CELLS_PER_BLOCK - 1) / CELLS_PER_BLOCK;
+    size_t num_after_blocks = (after_cells.size() + CELLS_PER_BLOCK - 1) / CELLS_PER_BLOCK;
+
+    std::vector<BlockResult> results(num_before_blocks + num_after_blocks);
+    parallel_for(results.size(), options_.num_threads, [&](size_t block) {
+        BlockResult& result = results[block];
+        if(block < num_before_blocks) {
+            size_t end = std::min(before_cells.size(), (block + 1) * CELLS_PER_BLOCK);
+            for(size_t icell = block * CELLS_PER_BLOCK; icell < end; ++icell) {
+                const Cell& cell = before_cells[icell];
+                const Cell* after_cell = after.find_cell(cell.instance());
+                if(!after_cell || before.find_cell(cell.instance()) != &cell) {
+                    result.cells.push_back(CellDiff{DiffKind::REMOVED, &cell, nullptr});
+                    continue;
+                }
+
+                ++result.num_matched_cells;
+                if(cell.celltype() != after_cell->celltype()) {
+                    result.cells.push_back(CellDiff{DiffKind::CHANGED, &cell, after_cell});
+                }
+                compare_iopaths(before, after, cell, *after_cell, result);
+                if(options_.compare_timing_checks) {
+                    compare_timing_checks(cell, *after_cell, result);
+                }
+            }
+        } else {
+            size_t after_block = block - num_before_blocks;
+            size_t end = std::min(after_cells.size(), (after_block + 1) * CELLS_PER_BLOCK);
+            for(size_t icell = after_block * CELLS_PER_BLOCK; icell < end; ++icell) {
+                const Cell& cell = after_cells[icell];
+                if(!before.find_cell(cell.instance()) || after.find_cell(cell.instance()) != &cell) {
+                    result.cells.push_back(CellDiff{DiffKind::ADDED, &cell, nullptr});
+                }
+            }
+        }
+    });
+
+    for(const BlockResult& result : results) {
+        cells_.insert(cells_.end(), result.cells.begin(), result.cells.end());
+        iopaths_.insert(iopaths_.end(), result.iopaths.begin(), result.iopaths.end());
+        timing_checks_.insert(timing_checks_.end(), result.timing_checks.begin(), result.timing_checks.end());
+        num_matched_cells_ += result.num_matched_cells;
+        num_compared_iopaths_ += result.num_compared_iopaths;
+        num_compared_timing_checks_ += result.num_compared_timing_checks;
+    }
+}
+
+void DelayFileDiff::compare_iopaths(const DelayFile& before, const DelayFile& after,
+                                    const Cell& before_cell, const Cell& after_cell, BlockResult& result) const {
+    ArrayView<Iopath> before_iopaths = before_cell.delay().iopaths();
+    ArrayView<Iopath> after_iopaths = after_cell.delay().iopaths();
+
+    auto compare = [&](const Iopath& before_iopath, const Iopath& after_iopath) {
+        ++result.num_compared_iopaths;
+        if(!equal(before_iopath.rise(), after_iopath.rise()) || !equal(before_iopath.fall(), after_iopath.fall())) {
+            result.iopaths.push_back(IopathDiff{DiffKind::CHANGED, &before_cell, &before_iopath, &after_iopath});
+        }
+    };
+
+    //Usually the IOPATHs are in the same order, and can be compared directly
+    bool same_order = (before_iopaths.size() == after_iopaths.size());
+    for(size_t i = 0; same_order && i < before_iopaths.size(); ++i) {
+        same_order = same_arc(before_iopaths[i], after_iopaths[i]);
+    }
+    if(same_order) {
+        for(size_t i = 0; i < before_iopaths.size(); ++i) {
+            compare(before_iopaths[i], after_iopaths[i]);
+        }
+        return;
+    }
+
+    for(const Iopath& iopath : before_iopaths) {
+        const PortSpec& input = iopath.input();
+        const Iopath* after_iopath = after.find_iopath(after_cell, input.port(), iopath.output().port(), input.condition());
+        if(!after_iopath || before.find_iopath(before_cell, input.port(), iopath.output().port(), input.condition()) != &iopath) {
+            result.iopaths.push_back(IopathDiff{DiffKind::REMOVED, &before_cell, &iopath, nullptr});
+        } else {
+            compare(iopath, *after_iopath);
+        }
+    }
+    for(const Iopath& iopath : after_iopaths) {
+        const PortSpec& input = iopath.input();
+        if(!before.find_iopath(before_cell, input.port(), iopath.output().port(), input.condition())
+           || after.find_iopath(after_cell, input.port(), iopath.output().port(), input.condition()) != &iopath) {
+            result.iopaths.push_back(IopathDiff{DiffKind::ADDED, &after_cell, nullptr, &iopath});
+        }
+    }
+}
+
+void DelayFileDiff::compare_timing_checks(const Cell& before_cell, const Cell& after_cell, BlockResult& result) const {
+    ArrayView<Timing> before_timings = before_cell.timing_check().timing();
+    ArrayView<Timing> after_timings = after_cell.timing_check().timing();
+
+    auto compare = [&](const Timing& before_timing, const Timing& after_timing) {
+        ++result.num_compared_timing_checks;
+        if(!equal(before_timing.t(), after_timing.t())) {
+            result.timing_checks.push_back(TimingDiff{DiffKind::CHANGED, &before_cell, &before_timing, &after_timing});
+        }
+    };
+
+    bool same_order = (before_timings.size() == after_timings.size());
+    for(size_t i = 0; same_order && i < before_timings.size(); ++i) {
+        same_order = same_arc(before_timings[i], after_timings[i]);
+    }
+    if(same_order) {
+        for(size_t i = 0; i < before_timings.size(); ++i) {
+            compare(before_timings[i], after_timings[i]);
+        }
+        return;
+    }
+
+    //Cells have few timing checks, so they are matched by searching
+    //(for the first check with the same type and ports)
+    auto find_first = [](ArrayView<Timing> timings, const Timing& timing) -> const Timing* {
+        for(const Timing& candidate : timings) {
+            if(same_arc(candidate, timing)) {
+                return &candidate;
+            }
+        }
+        return nullptr;
+    };
+
+    for(const Timing& timing : before_timings) {
+        const Timing* after_timing = find_first(after_timings, timing);
+        if(!after_timing || find_first(before_timings, timing) != &timing) {
+            result.timing_checks.push_back(TimingDiff{DiffKind::REMOVED, &before_cell, &timing, nullptr});
+        } else {
+            compare(timing, *after_timing);
+        }
+    }
+    for(const Timing& timing : after_timings) {
+        if(!find_first(before_timings, timing) || find_first(after_timings, timing) != &timing) {
+            result.timing_checks.push_back(TimingDiff{DiffKind::ADDED, &after_cell, nullptr, &timing});
+        }
+    }
+}
+
+bool DelayFileDiff::equal(const RealTriple& before, const RealTriple& after) const {
+    return values_equal(before.min(), after.min() * after_factor_, options_)
+           && values_equal(before.typ(), after.typ() * after_factor_, options_)
+           && values_equal(before.max(), after.max() * after_factor_, options_);
+}
+
+//Converts a value of the second file to the first's units
+RealTriple DelayFileDiff::in_before_units(const RealTriple& after) const {
+    return RealTriple(after.min() * after_factor_, after.typ() * after_factor_, after.max() * after_factor_);
+}
+
+void DelayFileDiff::print(std::ostream& os) const {
+    for(const CellDiff& diff : cells_) {
+        os << diff_symbol(diff.kind) << " CELL " << diff.cell->celltype();
+        if(diff.after) {
+            os << " -> " << diff.after->celltype();
+        }
+        os << " " << diff.cell->instance() << "\n";
+    }
+
+    for(const IopathDiff& diff : iopaths_) {
+        const Iopath& iopath = (diff.before) ? *diff.before : *diff.after;
+        os << diff_symbol(diff.kind) << " IOPATH " << diff.cell->instance() << " " << iopath.input() << " " << iopath.output();
+        print_values(os, "rise", (diff.before) ? &diff.before->rise() : nullptr, (diff.after) ? &diff.after->rise() : nullptr);
+        print_values(os, "fall", (diff.before) ? &diff.before->fall() : nullptr, (diff.after) ? &diff.after->fall() : nullptr);
+        os << "\n";
+    }
+
+    for(const TimingDiff& diff : timing_checks_) {
+        const Timing& timing = (diff.before) ? *diff.before : *diff.after;
+        RealTriple before_t = (diff.before) ? diff.before->t() : RealTriple();
+        RealTriple after_t = (diff.after) ? diff.after->t() : RealTriple();
+        os << diff_symbol(diff.kind) << " " << timing.type() << " " << diff.cell->instance() << " " << timing.port() << " " << timing.clock();
+        print_values(os, "", (diff.before) ? &before_t : nullptr, (diff.after) ? &after_t : nullptr);
+        os << "\n";
+    }
+}
+
+//Prints the values (as ' name before -> after'), or just one if only one is
+//present or they are equal, with after converted to the first file's units
+void DelayFileDiff::print_values(std::ostream& os, const char* name, const RealTriple* before, const RealTriple* after) const {
+    os << " ";
+    if(*name) {
+        os << name << " ";
+    }
+    if(before && after && !equal(*before, *after)) {
+        os << *before << " -> " << in_before_units(*after);
+    } else if(before) {
+        os << *before;
+    } else {
+        os << in_before_units(*after);
+    }
+}
+
+void DelayFileDiff::print_summary(std::ostream& os) const {
+    size_t num_cells[3] = {0, 0, 0};
+    size_t num_iopaths[3] = {0, 0, 0};
+    size_t num_timing_checks[3] = {0, 0, 0};
+    for(const CellDiff& diff : cells_) ++num_cells[static_cast<size_t>(diff.kind)];
+    for(const IopathDiff& diff : iopaths_) ++num_iopaths[static_cast<size_t>(diff.kind)];
+    for(const TimingDiff& diff : timing_checks_) ++num_timing_checks[static_cast<size_t>(diff.kind)];
+
+    os << "Cells: " << num_matched_cells_ << " matched, "
+       << num_cells[static_cast<size_t>(DiffKind::CHANGED)] << " changed CELLTYPE, "
+       << num_cells[static_cast<size_t>(DiffKind::REMOVED)] << " removed, "
+       << num_cells[static_cast<size_t>(DiffKind::ADDED)] << " added\n";
+    os << "IOPATHs: " << num_compared_iopaths_ << " compared, "
+       << num_iopaths[static_cast<size_t>(DiffKind::CHANGED)] << " changed, "
+       << num_iopaths[static_cast<size_t>(DiffKind::REMOVED)] << " removed, "
+       << num_iopaths[static_cast<size_t>(DiffKind::ADDED)] << " added\n";
+    if(options_.compare_timing_checks) {
+        os << "Timing checks: " << num_compared_timing_checks_ << " compared, "
+           << num_timing_checks[static_cast<size_t>(DiffKind::CHANGED)] << " changed, "
+           << num_timing_checks[static_cast<size_t>(DiffKind::REMOVED)] << " removed, "
+           << num_timing_checks[static_cast<size_t>(DiffKind::ADDED)] << " added\n";
+    }
+}
+
+} //sdfparse
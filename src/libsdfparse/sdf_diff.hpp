@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+#include "sdf_data.hpp"
+
+namespace sdfparse {
+
+//Controls how two DelayFiles are compared
+struct DiffOptions {
+    //Values a and b are equal if |a - b| <= max(abs_tolerance, rel_tolerance * max(|a|, |b|)),
+    //with abs_tolerance in the units of the first file's TIMESCALE. Empty
+    //(NaN) values are only equal to each other.
+    double abs_tolerance = 0.;
+    double rel_tolerance = 0.;
+
+    bool compare_timing_checks = true;
+
+    //Threads used to compare (0 uses one per hardware thread)
+    size_t num_threads = 0;
+};
+
+enum class DiffKind {
+    ADDED,   //Only in the second ('after') file
+    REMOVED, //Only in the first ('before') file
+    CHANGED  //In both, with different values
+};
+
+//A cell which is only in one of the files, or whose CELLTYPE differs
+//between them
+struct CellDiff {
+    DiffKind kind;
+    const Cell* cell; //From the file the cell is in (the first file if CHANGED)
+    const Cell* after; //From the second file if CHANGED (nullptr otherwise)
+};
+
+//An IOPATH which differs between the files
+struct IopathDiff {
+    DiffKind kind;
+    const Cell* cell; //From the file the IOPATH is in (the first file if CHANGED)
+    const Iopath* before; //nullptr if ADDED
+    const Iopath* after; //nullptr if REMOVED
+};
+
+//A timing check which differs between the files
+struct TimingDiff {
+    DiffKind kind;
+    const Cell* cell; //From the file the timing check is in (the first file if CHANGED)
+    const Timing* before; //nullptr if ADDED
+    const Timing* after; //nullptr if REMOVED
+};
+
+//The differences between two DelayFiles (e.g. before and after an ECO)
+//
+//Cells are matched by instance, IOPATHs by their input (and its edge
+//condition) and output ports, and timing checks by type and ports, using
+//the files' hash indexes (see DelayFile::find_cell()), so the comparison
+//is linear in the size of the files. Cells are compared in parallel.
+//
+//Cells only in one file are reported as whole cells (rather than as each
+//of their arcs). Matched cells with different CELLTYPEs are reported as
+//CHANGED, and their arcs are still compared. If an instance (or IOPATH)
+//is repeated within a file, only its first occurrence is matched and the
+//others are reported as added/removed. If the TIMESCALEs differ the
+//second file's values are converted to the first's units (throws
+//std::invalid_argument if either is not recognized).
+//
+//The differences refer to the cells of the compared files, which must
+//outlive the DelayFileDiff. They are ordered as in the files.
+class DelayFileDiff {
+    public:
+        DelayFileDiff(const DelayFile& before, const DelayFile& after, const DiffOptions& options=DiffOptions());
+
+        const std::vector<CellDiff>& cells() const { return cells_; }
+        const std::vector<IopathDiff>& iopaths() const { return iopaths_; }
+        const std::vector<TimingDiff>& timing_checks() const { return timing_checks_; }
+
+        //True if the files have no differences
+        bool empty() const { return cells_.empty() && iopaths_.empty() && timing_checks_.empty(); }
+
+        //The number of cells and arcs which were matched and compared
+        size_t num_matched_cells() const { return num_matched_cells_; }
+        size_t num_compared_iopaths() const { return num_compared_iopaths_; }
+        size_t num_compared_timing_checks() const { return num_compared_timing_checks_; }
+
+        //Prints one line per difference, e.g.
+        //  - CELL NAND2_X1 top/u_1
+        //  ~ CELL NAND2_X1 -> NAND2_X2 top/u_3
+        //  ~ IOPATH top/u_2 A Z rise (1:2:3) -> (1:2:4) fall (1:2:3)
+        //  + SETUP top/r_0 D (posedge CK) (1:2:3)
+        //with '-' for REMOVED, '+' for ADDED and '~' for CHANGED. All values
+        //are printed in the units of the first file's TIMESCALE.
+        void print(std::ostream& os) const;
+
+        //Prints the number of each kind of difference
+        void print_summary(std::ostream& os) const;
+
+    private:
+        struct BlockResult; //The differences found in a block of cells
+
+        void compare_iopaths(const DelayFile& before, const DelayFile& after,
+                             const Cell& before_cell, const Cell& after_cell, BlockResult& result) const;
+        void compare_timing_checks(const Cell& before_cell, const Cell& after_cell, BlockResult& result) const;
+
+        bool equal(const RealTriple& before, const RealTriple& after) const;
+        RealTriple in_before_units(const RealTriple& after) const;
+        void print_values(std::ostream& os, const char* name, const RealTriple* before, const RealTriple* after) const;
+
+    private:
+        DiffOptions options_;
+        double after_factor_; //Converts the second file's values to the first's units
+
+        std::vector<CellDiff> cells_;
+        std::vector<IopathDiff> iopaths_;
+        std::vector<TimingDiff> timing_checks_;
+
+        size_t num_matched_cells_ = 0;
+        size_t num_compared_iopaths_ = 0;
+        size_t num_compared_timing_checks_ = 0;
+};
+
+} //sdfparse
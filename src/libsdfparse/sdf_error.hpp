@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <stdexcept>
 #include <string>
 
@@ -7,17 +8,28 @@
 
 namespace sdfparse {
 
+//An error in an SDF file
+//
+//The error keeps its own copy of the location's file name, so loc() remains
+//valid after whatever the location referred to (e.g. a LazyDelayFile being
+//destroyed while the error propagates) has gone.
 class ParseError : public std::runtime_error {
     public:
         ParseError(const std::string& msg, location new_loc)
             : std::runtime_error(msg)
-            , loc_(new_loc)
-            {}
+            , loc_(new_loc) {
+            if(loc_.begin.filename) {
+                filename_ = std::make_shared<const std::string>(*loc_.begin.filename);
+                loc_.begin.filename = filename_.get();
+                loc_.end.filename = filename_.get();
+            }
+        }
 
-        location loc() { return loc_; }
+        location loc() const { return loc_; }
 
     private:
         location loc_;
+        std::shared_ptr<const std::string> filename_; //Referred to by loc_ (shared by copies)
 };
 
 }
@@ -1,103 +1,130 @@
 #include "sdf_escape.hpp"
-#include <locale>
+#include <cstring>
 
-bool is_special_sdf_char(char c);
+//Special characters in SDF identifiers
+//
+//From section 3.2.5 of IEEE1497 Part 3 (i.e. the SDF spec)
+//Special characters run from:
+//    ! to # (ASCII decimal 33-35)
+//    % to / (ASCII decimal 37-47)
+//    : to @ (ASCII decimal 58-64)
+//    [ to ^ (ASCII decimal 91-94)
+//    ` to ` (ASCII decimal 96)
+//    { to ~ (ASCII decimal 123-126)
+//
+//Not that the spec defines _ (decimal code 95) and $ (decimal code 36) 
+//as non-special alphanumeric characters. 
+//
+//However it inconsistently also lists $ in the list of special characters.
+//Since the spec allows for non-special characters to be escaped (they are treated
+//normally), we treat $ as a special character to be safe.
+//
+//Note that the spec appears to have rendering errors in the PDF availble
+//on IEEE Xplore, listing the 'LEFT-POINTING DOUBLE ANGLE QUOTATION MARK' 
+//character (decimal code 171) in place of the APOSTROPHE character ' 
+//with decimal code 39 in the special character list. We assume code 39
+const unsigned char SDF_SPECIAL_CHARS[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0-15
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //16-31
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, //32-47
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, //48-63
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //64-79
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, //80-95
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //96-111
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, //112-127
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //128-143
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //144-159
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //160-175
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //176-191
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //192-207
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //208-223
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //224-239
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //240-255
+};
 
-
-//Returns true if c is categorized as a special character in SDF
-bool is_special_sdf_char(char c) {
-    //From section 3.2.5 of IEEE1497 Part 3 (i.e. the SDF spec)
-    //Special characters run from:
-    //    ! to # (ASCII decimal 33-35)
-    //    % to / (ASCII decimal 37-47)
-    //    : to @ (ASCII decimal 58-64)
-    //    [ to ^ (ASCII decimal 91-94)
-    //    ` to ` (ASCII decimal 96)
-    //    { to ~ (ASCII decimal 123-126)
-    //
-    //Not that the spec defines _ (decimal code 95) and $ (decimal code 36) 
-    //as non-special alphanumeric characters. 
-    //
-    //However it inconsistently also lists $ in the list of special characters.
-    //Since the spec allows for non-special characters to be escaped (they are treated
-    //normally), we treat $ as a special character to be safe.
-    //
-    //Note that the spec appears to have rendering errors in the PDF availble
-    //on IEEE Xplore, listing the 'LEFT-POINTING DOUBLE ANGLE QUOTATION MARK' 
-    //character (decimal code 171) in place of the APOSTROPHE character ' 
-    //with decimal code 39 in the special character list. We assume code 39
-    if((c >= 33 && c <= 35) ||
-       (c == 36) || // $
-       (c >= 37 && c <= 47) ||
-       (c >= 58 && c <= 64) ||
-       (c >= 91 && c <= 94) ||
-       (c == 96) ||
-       (c >= 123 && c <= 126)) {
-        return true;
+size_t sdf_escape_end(const char* str, size_t len, EscapeStyle style) {
+    if(style == EscapeStyle::EXCLUDE_LAST_INDEX && len > 0 && str[len - 1] == ']') {
+        //Determine if we have a valid index (only digits between the brackets) at the end
+        for(size_t i = len - 1; i-- > 0; ) {
+            char c = str[i];
+            if(c == '[') {
+                return i; //Only escape up to the last index
+            } else if(c < '0' || c > '9') {
+                break;
+            }
+        }
     }
-
-    return false;
+    return len;
 }
 
-//Escapes the given identifier to be safe for sdf
-std::string escape_sdf_identifier(const std::string identifier, EscapeStyle style) {
-    //SDF allows escaped characters
-    //
-    //We look at each character in the string and escape it if it is
-    //a special character
-    std::string escaped_name;
-    std::string postfix = "";
+bool is_clean_sdf_identifier(const char* str, size_t len, EscapeStyle style) {
+    size_t end = sdf_escape_end(str, len, style);
+    for(size_t i = 0; i < end; ++i) {
+        if(is_special_sdf_char(str[i])) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    auto end = identifier.size();
+size_t escape_sdf_identifier(const char* str, size_t len, char* out, EscapeStyle style) {
+    size_t end = sdf_escape_end(str, len, style);
 
-    if(style == EscapeStyle::EXCLUDE_LAST_INDEX) {
-        //Determine if we have a valid index at the end
-        auto last_open_bracket = identifier.find_last_of("[");
-        auto last_end_bracket = identifier.find_last_of("]");
+    char* pos = out;
+    for(size_t i = 0; i < end; ++i) {
+        char c = str[i];
+        if(is_special_sdf_char(c)) {
+            //Escape the special character
+            *pos++ = '\\';
+        }
+        *pos++ = c;
+    }
 
-        bool ends_with_close_bracket = (last_end_bracket == identifier.size() - 1);
-        bool has_open_bracket = (last_open_bracket < last_end_bracket);
+    //Copy the unescaped last index (if any)
+    std::memcpy(pos, str + end, len - end);
+    pos += len - end;
 
-        if(has_open_bracket && ends_with_close_bracket) {
-            bool only_integers_between_brackets = true;
-            for(size_t i = last_open_bracket + 1; i < last_end_bracket; i++) {
-                if(!std::isdigit(identifier[i])) {
-                    only_integers_between_brackets = false;
-                }
-            }
+    return pos - out;
+}
 
-            if(only_integers_between_brackets) {
-                //Copy the unescaped last indexing
-                postfix = std::string(identifier, last_open_bracket, std::string::npos);
+size_t unescape_sdf_identifier_in_place(char* str, size_t len) {
+    //Most identifiers have no escapes, so find the first quickly
+    char* src = static_cast<char*>(std::memchr(str, '\\', len));
+    if(!src) {
+        return len;
+    }
 
-                //Only escape up to the last index
-                end = last_open_bracket;
-            }
+    //Remove all back-slashes, compacting the remainder
+    char* end = str + len;
+    char* dst = src;
+    for(; src != end; ++src) {
+        if(*src != '\\') {
+            *dst++ = *src;
         }
     }
+    return dst - str;
+}
 
-    for(size_t i = 0; i < end; ++i) {
-        char c = identifier[i];
-        if(is_special_sdf_char(c)) {
-            //Escape the special character
-            escaped_name += '\\';
-        }
-        escaped_name += c;
+void unescape_sdf_identifier_in_place(std::string& str) {
+    if(!str.empty()) {
+        str.resize(unescape_sdf_identifier_in_place(&str[0], str.size()));
     }
+}
 
-    //Used to append unescaped index if needed
-    escaped_name += postfix;
+//Escapes the given identifier to be safe for sdf
+std::string escape_sdf_identifier(const std::string& identifier, EscapeStyle style) {
+    if(is_clean_sdf_identifier(identifier.data(), identifier.size(), style)) {
+        return identifier;
+    }
 
+    std::string escaped_name(2 * identifier.size(), '\0');
+    escaped_name.resize(escape_sdf_identifier(identifier.data(), identifier.size(), &escaped_name[0], style));
     return escaped_name;
 }
 
 //Unsecapes and SDF identifier by removeing all back-slashes
-std::string unescape_sdf_identifier(const std::string str) {
-    std::string unescaped;
-    for(char c : str) {
-        if(c != '\\') {
-            unescaped += c;
-        }
-    }
+std::string unescape_sdf_identifier(const std::string& str) {
+    std::string unescaped = str;
+    unescape_sdf_identifier_in_place(unescaped);
     return unescaped;
 }
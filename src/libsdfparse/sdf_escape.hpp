@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <string>
 
 //Describes how to escape a string
@@ -7,5 +8,28 @@ enum class EscapeStyle {
     EXCLUDE_LAST_INDEX //Escape all characters except for final indexing
 };
 
-std::string escape_sdf_identifier(const std::string identifier, EscapeStyle style=EscapeStyle::ALL_CHARS);
-std::string unescape_sdf_identifier(const std::string str);
+//Non-zero for characters which are special in SDF identifiers (indexed by unsigned char)
+extern const unsigned char SDF_SPECIAL_CHARS[256];
+
+//Returns true if c must be escaped in an SDF identifier
+inline bool is_special_sdf_char(char c) {
+    return SDF_SPECIAL_CHARS[static_cast<unsigned char>(c)];
+}
+
+//Returns the end of the part of str (of length len) which is escaped with
+//the specified style (i.e. excluding any final index for EXCLUDE_LAST_INDEX)
+size_t sdf_escape_end(const char* str, size_t len, EscapeStyle style);
+
+//Returns true if escaping str (of length len) would leave it unchanged
+bool is_clean_sdf_identifier(const char* str, size_t len, EscapeStyle style=EscapeStyle::ALL_CHARS);
+
+//Escapes str (of length len) into out, which must have space for 2*len
+//characters, returning the number of characters written
+size_t escape_sdf_identifier(const char* str, size_t len, char* out, EscapeStyle style=EscapeStyle::ALL_CHARS);
+
+//Unescapes str (of length len) in-place, returning its new length
+size_t unescape_sdf_identifier_in_place(char* str, size_t len);
+void unescape_sdf_identifier_in_place(std::string& str);
+
+std::string escape_sdf_identifier(const std::string& identifier, EscapeStyle style=EscapeStyle::ALL_CHARS);
+std::string unescape_sdf_identifier(const std::string& str);
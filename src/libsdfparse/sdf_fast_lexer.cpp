@@ -0,0 +1,414 @@
+#include <cstring>
+#include <istream>
+#include <sstream>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+# include <immintrin.h>
+#endif
+
+#include "sdf_fast_lexer.hpp"
+#include "sdf_number.hpp"
+
+namespace /*anonymous*/ {
+
+//Size of the blocks read from stream input
+constexpr size_t STREAM_BLOCK_SIZE = 1 << 20;
+
+//Character classes, matching those defined in sdf_lexer.l
+enum CharClass : unsigned char {
+    CHAR_ALPHA  = 1 << 0,
+    CHAR_DIGIT  = 1 << 1,
+    CHAR_SYMBOL = 1 << 2,
+};
+
+struct CharClassTable {
+    CharClassTable() {
+        std::fill(std::begin(table), std::end(table), 0);
+        for(int c = 'a'; c <= 'z'; ++c) table[c] |= CHAR_ALPHA;
+        for(int c = 'A'; c <= 'Z'; ++c) table[c] |= CHAR_ALPHA;
+        for(int c = '0'; c <= '9'; ++c) table[c] |= CHAR_DIGIT;
+        for(unsigned char c : std::string("-_~|*/[].{}^+$\\")) table[c] |= CHAR_SYMBOL;
+    }
+
+    unsigned char table[256];
+};
+const CharClassTable char_classes;
+
+inline bool is_ident_start(char c) {
+    return char_classes.table[static_cast<unsigned char>(c)] & (CHAR_ALPHA | CHAR_SYMBOL);
+}
+
+inline bool is_ident_char(char c) {
+    return char_classes.table[static_cast<unsigned char>(c)] & (CHAR_ALPHA | CHAR_DIGIT | CHAR_SYMBOL);
+}
+
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+#if defined(__AVX2__)
+
+//Returns a mask with 0xFF for bytes in [lo, hi] (lo > 0, hi < 0x7F)
+inline __m256i in_range(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+//Returns a bit mask with bits set for bytes which are blanks
+inline unsigned blank_mask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    return static_cast<unsigned>(_mm256_movemask_epi8(blank));
+}
+
+//Returns a bit mask with bits set for bytes which are identifier characters
+inline unsigned ident_mask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+    __m256i ident = in_range(lower, 'a', 'z');
+    ident = _mm256_or_si256(ident, in_range(v, '0', '9'));
+    ident = _mm256_or_si256(ident, in_range(v, '[', '^')); // [ \ ] ^
+    ident = _mm256_or_si256(ident, in_range(v, '{', '~')); // { | } ~
+    ident = _mm256_or_si256(ident, _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')),
+                                                       in_range(v, '*', '/'))); // * + - . /
+    ident = _mm256_or_si256(ident, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    ident = _mm256_or_si256(ident, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('$')));
+    return static_cast<unsigned>(_mm256_movemask_epi8(ident));
+}
+
+constexpr size_t SIMD_WIDTH = 32;
+constexpr unsigned SIMD_ALL = 0xFFFFFFFFu;
+
+#elif defined(__SSE2__)
+
+//Returns a mask with 0xFF for bytes in [lo, hi] (lo > 0, hi < 0x7F)
+inline __m128i in_range(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+//Returns a bit mask with bits set for bytes which are blanks
+inline unsigned blank_mask(const char* p) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    return static_cast<unsigned>(_mm_movemask_epi8(blank));
+}
+
+//Returns a bit mask with bits set for bytes which are identifier characters
+inline unsigned ident_mask(const char* p) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+    __m128i ident = in_range(lower, 'a', 'z');
+    ident = _mm_or_si128(ident, in_range(v, '0', '9'));
+    ident = _mm_or_si128(ident, in_range(v, '[', '^')); // [ \ ] ^
+    ident = _mm_or_si128(ident, in_range(v, '{', '~')); // { | } ~
+    ident = _mm_or_si128(ident, _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')),
+                                                 in_range(v, '*', '/'))); // * + - . /
+    ident = _mm_or_si128(ident, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    ident = _mm_or_si128(ident, _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+    return static_cast<unsigned>(_mm_movemask_epi8(ident));
+}
+
+constexpr size_t SIMD_WIDTH = 16;
+constexpr unsigned SIMD_ALL = 0xFFFFu;
+
+#endif
+
+//Returns the first character in [p, end) which is not a blank
+const char* skip_blanks(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while(end - p >= static_cast<ptrdiff_t>(SIMD_WIDTH)) {
+        unsigned mask = blank_mask(p);
+        if(mask != SIMD_ALL) {
+            return p + __builtin_ctz(~mask);
+        }
+        p += SIMD_WIDTH;
+    }
+#endif
+    while(p != end && is_blank(*p)) ++p;
+    return p;
+}
+
+//Returns the first character in [p, end) which is not an identifier character
+const char* skip_ident_chars(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while(end - p >= static_cast<ptrdiff_t>(SIMD_WIDTH)) {
+        unsigned mask = ident_mask(p);
+        if(mask != SIMD_ALL) {
+            return p + __builtin_ctz(~mask);
+        }
+        p += SIMD_WIDTH;
+    }
+#endif
+    while(p != end && is_ident_char(*p)) ++p;
+    return p;
+}
+
+//Returns the first character in [p, end) which is not a digit
+//
+//Numbers are short, so this is always scalar
+const char* skip_digits(const char* p, const char* end) {
+    while(p != end && is_digit(*p)) ++p;
+    return p;
+}
+
+//Returns true if text starts with keyword (whose length has already been checked)
+template<size_t N>
+bool matches(const char* text, const char (&keyword)[N]) {
+    return std::memcmp(text, keyword, N - 1) == 0;
+}
+
+} //namespace
+
+namespace sdfparse {
+
+void FastSdfLexer::set_input(std::istream& is) {
+    is_ = &is;
+    bytes_read_ = 0;
+    buffer_.resize(STREAM_BLOCK_SIZE);
+    pos_ = buffer_.data();
+    end_ = pos_;
+}
+
+void FastSdfLexer::set_input(const char* begin, const char* end) {
+    is_ = nullptr;
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    pos_ = begin;
+    end_ = end;
+    bytes_read_ = end - begin;
+}
+
+sdfparse::Parser::symbol_type FastSdfLexer::next_token() {
+    //Move begining of location to end
+    loc_.step();
+
+    while(true) {
+        if(pos_ == end_ && !refill()) {
+            return sdfparse::Parser::make_EOF(loc_);
+        }
+
+        char c = *pos_;
+        switch(c) {
+            case ' ':
+            case '\t': {
+                //Skip white space
+                size_t len = scan_blanks(1);
+                pos_ += len;
+                loc_.columns(len);
+                loc_.step();
+                break;
+            }
+            case '\n': {
+                //Skip end-of-line
+                size_t len = (peek(1) == '\r') ? 2 : 1;
+                pos_ += len;
+                loc_.columns(len);
+                loc_.lines(1);
+                loc_.step();
+                break;
+            }
+            case '(':
+                ++pos_;
+                loc_.columns(1);
+                return sdfparse::Parser::make_LPAR(loc_);
+            case ')':
+                ++pos_;
+                loc_.columns(1);
+                return sdfparse::Parser::make_RPAR(loc_);
+            case ':':
+                ++pos_;
+                loc_.columns(1);
+                return sdfparse::Parser::make_COLON(loc_);
+            case '"': {
+                size_t len = scan_ident(1);
+                if(len > 1 && peek(len) == '"') {
+                    //Trim off the beginning and ending quotes
+                    std::string str(pos_ + 1, pos_ + len);
+                    pos_ += len + 1;
+                    loc_.columns(len + 1);
+                    return sdfparse::Parser::make_Qstring(str, loc_);
+                }
+                unexpected_character();
+            }
+            default: {
+                //Like flex, take the longest match, preferring
+                //floats over strings of the same length
+                size_t float_len = match_float();
+                size_t str_len = is_ident_start(c) ? scan_ident(1) : 0;
+
+                if(str_len > float_len) {
+                    return make_keyword_or_string(str_len);
+                } else if(float_len > 0) {
+                    return make_float(float_len);
+                }
+                unexpected_character();
+            }
+        }
+    }
+}
+
+bool FastSdfLexer::refill() {
+    if(!is_ || !*is_) {
+        return false;
+    }
+
+    //Move the partial token to the start of the buffer,
+    //growing the buffer if the token occupies most of it
+    size_t pending = end_ - pos_;
+    if(2 * pending > buffer_.size()) {
+        std::vector<char> new_buffer(2 * buffer_.size());
+        std::copy(pos_, end_, new_buffer.begin());
+        buffer_.swap(new_buffer);
+    } else if(pending > 0) {
+        std::memmove(buffer_.data(), pos_, pending);
+    }
+
+    is_->read(buffer_.data() + pending, buffer_.size() - pending);
+    size_t num_read = is_->gcount();
+    bytes_read_ += num_read;
+
+    pos_ = buffer_.data();
+    end_ = pos_ + pending + num_read;
+
+    return num_read > 0;
+}
+
+size_t FastSdfLexer::scan_blanks(size_t offset) {
+    while(true) {
+        const char* p = skip_blanks(pos_ + offset, end_);
+        offset = p - pos_;
+        if(p != end_ || !refill()) return offset;
+    }
+}
+
+size_t FastSdfLexer::scan_ident(size_t offset) {
+    while(true) {
+        const char* p = skip_ident_chars(pos_ + offset, end_);
+        offset = p - pos_;
+        if(p != end_ || !refill()) return offset;
+    }
+}
+
+size_t FastSdfLexer::scan_digits(size_t offset) {
+    while(true) {
+        const char* p = skip_digits(pos_ + offset, end_);
+        offset = p - pos_;
+        if(p != end_ || !refill()) return offset;
+    }
+}
+
+char FastSdfLexer::peek(size_t offset) {
+    if(pos_ + offset == end_ && !refill()) {
+        return '\0';
+    }
+    return pos_[offset];
+}
+
+size_t FastSdfLexer::match_float() {
+    //Matches the flex pattern: [-+]?({DIGIT}*\.?{DIGIT}+|{DIGIT}+\.)
+    size_t int_begin = (*pos_ == '-' || *pos_ == '+') ? 1 : 0;
+    size_t int_end = scan_digits(int_begin);
+    bool has_int_digits = (int_end > int_begin);
+
+    if(peek(int_end) == '.') {
+        size_t frac_end = scan_digits(int_end + 1);
+        if(frac_end > int_end + 1) {
+            return frac_end; //[-+]?{DIGIT}*\.{DIGIT}+
+        } else if(has_int_digits) {
+            return int_end + 1; //[-+]?{DIGIT}+\.
+        }
+    }
+
+    if(has_int_digits) {
+        return int_end; //[-+]?{DIGIT}+
+    }
+    return 0;
+}
+
+sdfparse::Parser::symbol_type FastSdfLexer::make_keyword_or_string(size_t len) {
+    const char* text = pos_;
+    pos_ += len;
+    loc_.columns(len);
+
+    //Keywords are identified by length, then compared directly
+    switch(len) {
+        case 4:
+            if(matches(text, "CELL")) return sdfparse::Parser::make_CELL(loc_);
+            if(matches(text, "HOLD")) return sdfparse::Parser::make_HOLD(loc_);
+            break;
+        case 5:
+            if(matches(text, "DELAY")) return sdfparse::Parser::make_DELAY(loc_);
+            if(matches(text, "SETUP")) return sdfparse::Parser::make_SETUP(loc_);
+            break;
+        case 6:
+            if(matches(text, "IOPATH")) return sdfparse::Parser::make_IOPATH(loc_);
+            if(matches(text, "DESIGN")) return sdfparse::Parser::make_DESIGN(loc_);
+            if(matches(text, "VENDOR")) return sdfparse::Parser::make_VENDOR(loc_);
+            break;
+        case 7:
+            if(matches(text, "posedge")) return sdfparse::Parser::make_POSEDGE(loc_);
+            if(matches(text, "negedge")) return sdfparse::Parser::make_NEGEDGE(loc_);
+            if(matches(text, "PROGRAM")) return sdfparse::Parser::make_PROGRAM(loc_);
+            if(matches(text, "VERSION")) return sdfparse::Parser::make_VERSION(loc_);
+            if(matches(text, "DIVIDER")) return sdfparse::Parser::make_DIVIDER(loc_);
+            if(matches(text, "REMOVAL")) return sdfparse::Parser::make_REMOVAL(loc_);
+            break;
+        case 8:
+            if(matches(text, "CELLTYPE")) return sdfparse::Parser::make_CELLTYPE(loc_);
+            if(matches(text, "INSTANCE")) return sdfparse::Parser::make_INSTANCE(loc_);
+            if(matches(text, "ABSOLUTE")) return sdfparse::Parser::make_ABSOLUTE(loc_);
+            if(matches(text, "RECOVERY")) return sdfparse::Parser::make_RECOVERY(loc_);
+            break;
+        case 9:
+            if(matches(text, "DELAYFILE")) return sdfparse::Parser::make_DELAYFILE(loc_);
+            if(matches(text, "TIMESCALE")) return sdfparse::Parser::make_TIMESCALE(loc_);
+            break;
+        case 10:
+            if(matches(text, "SDFVERSION")) return sdfparse::Parser::make_SDFVERSION(loc_);
+            break;
+        case 11:
+            if(matches(text, "TIMINGCHECK")) return sdfparse::Parser::make_TIMINGCHECK(loc_);
+            break;
+        default:
+            break;
+    }
+
+    return sdfparse::Parser::make_String(std::string(text, len), loc_);
+}
+
+sdfparse::Parser::symbol_type FastSdfLexer::make_float(size_t len) {
+    const char* text = pos_;
+    pos_ += len;
+    loc_.columns(len);
+
+    double val;
+    if(!parse_sdf_number(text, text + len, val)) {
+        std::stringstream msg_ss;
+        msg_ss << "Failed to parse float number '" << std::string(text, len) << "'";
+        throw sdfparse::ParseError(msg_ss.str(), loc_);
+    }
+
+    return sdfparse::Parser::make_Float(val, loc_);
+}
+
+void FastSdfLexer::unexpected_character() {
+    char c = *pos_;
+    ++pos_;
+    loc_.columns(1);
+
+    std::stringstream ss;
+    ss << "Unexpected character '" << c << "'";
+    throw sdfparse::ParseError(ss.str(), loc_);
+}
+
+} //sdfparse
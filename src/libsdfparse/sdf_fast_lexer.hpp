@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "sdf_lexer.hpp"
+
+namespace sdfparse {
+
+//A hand-written SDF lexer
+//
+//Produces exactly the same tokens (and locations) as the flex
+//generated FlexSdfLexer, but scans runs of blanks and identifier
+//characters with SIMD character-class tests (SSE2/AVX2 where available,
+//with a scalar fallback) and classifies keywords directly.
+//
+//In-memory input is scanned in place; stream input is read in large
+//blocks into an internal buffer.
+class FastSdfLexer : public Lexer {
+    public:
+        sdfparse::Parser::symbol_type next_token() override;
+
+        void set_input(std::istream& is) override;
+        void set_input(const char* begin, const char* end) override;
+
+    private:
+        //Reads more stream input, preserving the bytes in [pos_, end_).
+        //Returns false if no more input is available.
+        bool refill();
+
+        //Returns the offset (from pos_) of the first character at or after
+        //offset which is not a blank/identifier/digit character, refilling as needed
+        size_t scan_blanks(size_t offset);
+        size_t scan_ident(size_t offset);
+        size_t scan_digits(size_t offset);
+
+        //Returns the character at pos_ + offset, or '\0' at end of input
+        char peek(size_t offset);
+
+        //Returns the length of the longest float literal starting at pos_
+        size_t match_float();
+
+        //Consumes len characters and returns the specified token
+        sdfparse::Parser::symbol_type make_keyword_or_string(size_t len);
+        sdfparse::Parser::symbol_type make_float(size_t len);
+
+        [[noreturn]] void unexpected_character();
+
+    private:
+        const char* pos_ = nullptr; //Start of the current token
+        const char* end_ = nullptr; //End of the currently available input
+
+        std::istream* is_ = nullptr; //Stream input (nullptr for in-memory input)
+        std::vector<char> buffer_; //Buffer for stream input
+};
+
+} //sdfparse
@@ -0,0 +1,133 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "sdf_fixed.hpp"
+#include "sdf_error.hpp"
+
+namespace /*anonymous*/ {
+
+int unit_exponent(const std::string& unit);
+
+//Returns the power of 10 of the time unit (e.g. -9 for "ns"), or 1 if it is not recognized
+int unit_exponent(const std::string& unit) {
+    static const struct {
+        const char* name;
+        int exponent;
+    } units[] = {
+        {"s", 0}, {"ms", -3}, {"us", -6}, {"ns", -9}, {"ps", -12}, {"fs", -15}
+    };
+    for(const auto& known_unit : units) {
+        if(unit == known_unit.name) {
+            return known_unit.exponent;
+        }
+    }
+    return 1;
+}
+
+} //namespace
+
+namespace sdfparse {
+
+double timescale_factor(const Timescale& timescale, FixedUnit unit) {
+    int exponent = unit_exponent(timescale.unit());
+    if(exponent > 0) {
+        throw std::invalid_argument("Unrecognized TIMESCALE unit '" + timescale.unit() + "'");
+    }
+    int unit_exponent = (unit == FixedUnit::FS) ? -15 : -12;
+    return timescale.value() * std::pow(10., exponent - unit_exponent);
+}
+
+template<typename T>
+FixedDelayFile<T>::FixedDelayFile(FixedUnit new_unit)
+    : unit_(new_unit)
+    , factor_(timescale_factor(header_.timescale(), new_unit)) {
+}
+
+template<typename T>
+FixedDelayFile<T>::FixedDelayFile(const DelayFile& delayfile, FixedUnit new_unit)
+    : FixedDelayFile(new_unit) {
+    set_header(delayfile.header());
+    symbols_ = delayfile.shared_symbols();
+
+    FlatSizes sizes = reserve_structure(delayfile);
+    rise_.reserve(sizes.num_iopaths);
+    fall_.reserve(sizes.num_iopaths);
+    timing_t_.reserve(sizes.num_timings);
+
+    for(const Cell& cell : delayfile.cells()) {
+        add_cell(cell, cell.instance_symbol());
+    }
+}
+
+template<typename T>
+void FixedDelayFile<T>::set_header(const Header& header) {
+    factor_ = timescale_factor(header.timescale(), unit_);
+    header_ = header;
+}
+
+template<typename T>
+void FixedDelayFile<T>::add_cell(const Cell& cell, Symbol instance) {
+    //Convert first, so a failure leaves the cell out entirely
+    ArrayView<Iopath> iopaths = cell.delay().iopaths();
+    ArrayView<Timing> timings = cell.timing_check().timing();
+    size_t num_iopaths = rise_.size();
+    size_t num_timings = timing_t_.size();
+    try {
+        for(const Iopath& iopath : iopaths) {
+            rise_.push_back(convert(iopath.rise()));
+            fall_.push_back(convert(iopath.fall()));
+        }
+        for(const Timing& timing : timings) {
+            timing_t_.push_back(convert(timing.t()));
+        }
+    } catch(...) {
+        rise_.resize(num_iopaths);
+        fall_.resize(num_iopaths);
+        timing_t_.resize(num_timings);
+        throw;
+    }
+
+    add_structure(cell, instance);
+}
+
+template<typename T>
+typename FixedDelayFile<T>::Triple FixedDelayFile<T>::convert(const RealTriple& triple) const {
+    return Triple(convert(triple.min()), convert(triple.typ()), convert(triple.max()));
+}
+
+template<typename T>
+T FixedDelayFile<T>::convert(double value) const {
+    if(std::isnan(value)) {
+        return Triple::EMPTY;
+    }
+
+    //EMPTY (the lowest value of T, -2^(N-1)) is reserved. The upper bound is
+    //the exclusive 2^(N-1), which (unlike the maximum of int64_t) is exact
+    //in a double; scaled is integral, so for int32_t this is <= the maximum.
+    double scaled = std::round(value * factor_);
+    if(!(scaled > static_cast<double>(Triple::EMPTY) && scaled < -static_cast<double>(Triple::EMPTY))) {
+        throw std::range_error("Delay value " + std::to_string(value) + " is out of range for fixed-point storage");
+    }
+    return static_cast<T>(scaled);
+}
+
+template<typename T>
+FixedLoader<T>::FixedLoader(FixedUnit unit)
+    : FlatStructureLoader<FixedDelayFile<T>>(FixedDelayFile<T>(unit)) {
+}
+
+template<typename T>
+void FixedLoader<T>::on_cell(Cell&& cell) {
+    try {
+        this->add_cell(cell);
+    } catch(std::range_error& error) {
+        throw ParseError(std::string(error.what()) + " (in instance " + cell.instance() + ")", this->current_location());
+    }
+}
+
+template class FixedDelayFile<int32_t>;
+template class FixedDelayFile<int64_t>;
+template class FixedLoader<int32_t>;
+template class FixedLoader<int64_t>;
+
+} //sdfparse
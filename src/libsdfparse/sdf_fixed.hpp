@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_flat.hpp"
+#include "sdf_loader.hpp"
+
+namespace sdfparse {
+
+//The resolution of fixed-point delays
+enum class FixedUnit {
+    FS, //Femtoseconds
+    PS  //Picoseconds
+};
+
+//Returns the factor converting values in the timescale to the unit
+//(e.g. 1000 from "1 ns" to FixedUnit::PS). Throws std::invalid_argument
+//if the timescale's unit is not recognized.
+double timescale_factor(const Timescale& timescale, FixedUnit unit);
+
+//A min:typ:max triple of integer delays
+//
+//Missing values (which are NaN in a RealTriple) hold the sentinel EMPTY,
+//which is below any valid value, so comparisons over triples are exact
+//integer operations.
+//
+//Unlike NaN, EMPTY is not ignored by arithmetic: it is the smallest value
+//of T, so a minimum over values which include an EMPTY one is EMPTY (while
+//a maximum ignores it), and it must not be scaled or added to. Reductions
+//which may see missing values should skip them (see has_min() etc.).
+template<typename T>
+class FixedTriple {
+    public:
+        static constexpr T EMPTY = std::numeric_limits<T>::min();
+
+        FixedTriple()
+            : min_(EMPTY)
+            , typ_(EMPTY)
+            , max_(EMPTY)
+            {}
+        FixedTriple(T new_min, T new_typ, T new_max)
+            : min_(new_min)
+            , typ_(new_typ)
+            , max_(new_max)
+            {}
+
+        T min() const { return min_; }
+        T typ() const { return typ_; }
+        T max() const { return max_; }
+
+        bool has_min() const { return min_ != EMPTY; }
+        bool has_typ() const { return typ_ != EMPTY; }
+        bool has_max() const { return max_ != EMPTY; }
+
+        //Whether all the values are missing
+        bool empty() const { return !has_min() && !has_typ() && !has_max(); }
+
+    private:
+        T min_;
+        T typ_;
+        T max_;
+};
+
+template<typename T>
+bool operator==(const FixedTriple<T>& lhs, const FixedTriple<T>& rhs) {
+    return lhs.min() == rhs.min() && lhs.typ() == rhs.typ() && lhs.max() == rhs.max();
+}
+
+template<typename T>
+bool operator!=(const FixedTriple<T>& lhs, const FixedTriple<T>& rhs) {
+    return !(lhs == rhs);
+}
+
+template<typename T>
+constexpr T FixedTriple<T>::EMPTY;
+
+//A structure-of-arrays representation of a DelayFile (see FlatStructure)
+//whose delays are stored as integers in a fixed unit
+//
+//Values are converted from the file's TIMESCALE when the file is loaded (so
+//consumers need not apply it), and rounded to the nearest unit. T is the
+//integer type used: with int32_t (the FixedDelayFile32 below) an IOPATH's
+//delays take half the space of two RealTriples, and values of
+//up to about 2 ms in picoseconds (2 us in femtoseconds) can be stored.
+//
+//The header() keeps the TIMESCALE of the original file. A FixedDelayFile
+//can be converted from a DelayFile, or built directly while parsing with a
+//FixedLoader.
+template<typename T>
+class FixedDelayFile : public FlatStructure {
+    public:
+        typedef T value_type;
+        typedef FixedTriple<T> Triple;
+
+        explicit FixedDelayFile(FixedUnit new_unit=FixedUnit::PS);
+
+        //Throws std::range_error if a value is out of range for T (or
+        //std::invalid_argument if the file's TIMESCALE is not recognized)
+        explicit FixedDelayFile(const DelayFile& delayfile, FixedUnit new_unit=FixedUnit::PS);
+
+        //The unit of all values
+        FixedUnit unit() const { return unit_; }
+
+        //Converts a value back to the original file's TIMESCALE
+        double to_timescale(T value) const { return value / factor_; }
+
+        //IOPATH values
+        const Triple& rise(size_t iopath) const { return rise_[iopath]; }
+        const Triple& fall(size_t iopath) const { return fall_[iopath]; }
+
+        //Timing check values
+        const Triple& timing_t(size_t timing) const { return timing_t_[timing]; }
+
+    private:
+        friend class FlatStructureLoader<FixedDelayFile>;
+
+        //Sets the header, and so the conversion factor
+        void set_header(const Header& header);
+
+        void add_cell(const Cell& cell, Symbol instance); //instance is the cell's (interned) instance
+
+        Triple convert(const RealTriple& triple) const;
+        T convert(double value) const;
+
+    private:
+        FixedUnit unit_;
+        double factor_; //Converts values in the file's TIMESCALE to unit_
+
+        std::vector<Triple> rise_;
+        std::vector<Triple> fall_;
+        std::vector<Triple> timing_t_;
+};
+
+//A Loader which builds a FixedDelayFile directly as the file is parsed.
+//Values which are out of range (or an unrecognized TIMESCALE) are reported
+//as errors.
+template<typename T>
+class FixedLoader : public FlatStructureLoader<FixedDelayFile<T>> {
+    public:
+        explicit FixedLoader(FixedUnit unit=FixedUnit::PS);
+
+        const FixedDelayFile<T>& get_fixed_delayfile() const { return this->delayfile_; }
+
+    protected:
+        void on_cell(Cell&& cell) override;
+};
+
+typedef FixedDelayFile<int32_t> FixedDelayFile32;
+typedef FixedDelayFile<int64_t> FixedDelayFile64;
+typedef FixedLoader<int32_t> FixedLoader32;
+typedef FixedLoader<int64_t> FixedLoader64;
+
+extern template class FixedDelayFile<int32_t>;
+extern template class FixedDelayFile<int64_t>;
+extern template class FixedLoader<int32_t>;
+extern template class FixedLoader<int64_t>;
+
+} //sdfparse
@@ -0,0 +1,90 @@
+#include "sdf_flat.hpp"
+
+namespace sdfparse {
+
+void TripleColumns::push_back(const RealTriple& value) {
+    min.push_back(value.min());
+    typ.push_back(value.typ());
+    max.push_back(value.max());
+}
+
+void TripleColumns::reserve(size_t num_values) {
+    min.reserve(num_values);
+    typ.reserve(num_values);
+    max.reserve(num_values);
+}
+
+FlatStructure::FlatStructure()
+    : symbols_(std::make_shared<SymbolTable>())
+    , iopath_offsets_(1, 0)
+    , timing_offsets_(1, 0) {
+}
+
+FlatSizes FlatStructure::reserve_structure(const DelayFile& delayfile) {
+    //Size the arrays exactly
+    FlatSizes sizes;
+    sizes.num_cells = delayfile.cells().size();
+    for(const Cell& cell : delayfile.cells()) {
+        sizes.num_iopaths += cell.delay().iopaths().size();
+        sizes.num_timings += cell.timing_check().timing().size();
+    }
+
+    celltypes_.reserve(sizes.num_cells);
+    instances_.reserve(sizes.num_cells);
+    iopath_offsets_.reserve(sizes.num_cells + 1);
+    timing_offsets_.reserve(sizes.num_cells + 1);
+
+    iopath_inputs_.reserve(sizes.num_iopaths);
+    iopath_outputs_.reserve(sizes.num_iopaths);
+
+    timing_types_.reserve(sizes.num_timings);
+    timing_clocks_.reserve(sizes.num_timings);
+    timing_ports_.reserve(sizes.num_timings);
+
+    return sizes;
+}
+
+void FlatStructure::add_structure(const Cell& cell, Symbol instance) {
+    celltypes_.push_back(cell.celltype_symbol());
+    instances_.push_back(instance);
+
+    for(const Iopath& iopath : cell.delay().iopaths()) {
+        iopath_inputs_.push_back(iopath.input());
+        iopath_outputs_.push_back(iopath.output());
+    }
+    iopath_offsets_.push_back(iopath_inputs_.size());
+
+    for(const Timing& timing : cell.timing_check().timing()) {
+        timing_types_.push_back(timing.timing_type());
+        timing_clocks_.push_back(timing.clock());
+        timing_ports_.push_back(timing.port());
+    }
+    timing_offsets_.push_back(timing_types_.size());
+}
+
+FlatDelayFile::FlatDelayFile(const DelayFile& delayfile) {
+    header_ = delayfile.header();
+    symbols_ = delayfile.shared_symbols();
+
+    FlatSizes sizes = reserve_structure(delayfile);
+    rise_.reserve(sizes.num_iopaths);
+    fall_.reserve(sizes.num_iopaths);
+    timing_t_.reserve(sizes.num_timings);
+
+    for(const Cell& cell : delayfile.cells()) {
+        add_cell(cell, cell.instance_symbol());
+    }
+}
+
+void FlatDelayFile::add_cell(const Cell& cell, Symbol instance) {
+    for(const Iopath& iopath : cell.delay().iopaths()) {
+        rise_.push_back(iopath.rise());
+        fall_.push_back(iopath.fall());
+    }
+    for(const Timing& timing : cell.timing_check().timing()) {
+        timing_t_.push_back(timing.t());
+    }
+    add_structure(cell, instance);
+}
+
+} //sdfparse
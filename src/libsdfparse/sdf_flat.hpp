@@ -0,0 +1,192 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_error.hpp"
+#include "sdf_loader.hpp"
+
+namespace sdfparse {
+
+//Selects one value of each min:typ:max triple
+enum class TripleValue {
+    MIN,
+    TYP,
+    MAX
+};
+
+//The min/typ/max values of a list of RealTriples, stored column-wise
+struct TripleColumns {
+    std::vector<double> min;
+    std::vector<double> typ;
+    std::vector<double> max;
+
+    size_t size() const { return min.size(); }
+    RealTriple operator[](size_t i) const { return RealTriple(min[i], typ[i], max[i]); }
+
+    void push_back(const RealTriple& value);
+    void reserve(size_t num_values);
+};
+
+//The number of cells, IOPATHs and timing checks in a DelayFile
+struct FlatSizes {
+    size_t num_cells = 0;
+    size_t num_iopaths = 0;
+    size_t num_timings = 0;
+};
+
+//The structure (cells, IOPATHs and timing checks, without their values) of
+//a DelayFile, stored as a structure of arrays
+//
+//The IOPATHs (and timing checks) of all cells are stored in single arrays,
+//with each cell's IOPATHs in the range [iopath_begin(cell), iopath_end(cell)).
+//The flat representations below (FlatDelayFile, CornerDelayFile,
+//FixedDelayFile and PooledDelayFile) derive from it, and differ only in how
+//they store the values of each IOPATH and timing check (in arrays parallel
+//to the structure's).
+class FlatStructure {
+    public:
+        const Header& header() const { return header_; }
+        const SymbolTable& symbols() const { return *symbols_; }
+
+        //Cells
+        size_t num_cells() const { return celltypes_.size(); }
+        Symbol celltype(size_t cell) const { return celltypes_[cell]; }
+        Symbol instance(size_t cell) const { return instances_[cell]; }
+        size_t iopath_begin(size_t cell) const { return iopath_offsets_[cell]; }
+        size_t iopath_end(size_t cell) const { return iopath_offsets_[cell + 1]; }
+        size_t timing_begin(size_t cell) const { return timing_offsets_[cell]; }
+        size_t timing_end(size_t cell) const { return timing_offsets_[cell + 1]; }
+
+        //IOPATHs
+        size_t num_iopaths() const { return iopath_inputs_.size(); }
+        const PortSpec& iopath_input(size_t iopath) const { return iopath_inputs_[iopath]; }
+        const PortSpec& iopath_output(size_t iopath) const { return iopath_outputs_[iopath]; }
+
+        //Timing checks
+        size_t num_timings() const { return timing_types_.size(); }
+        TimingType timing_type(size_t timing) const { return timing_types_[timing]; }
+        const PortSpec& timing_clock(size_t timing) const { return timing_clocks_[timing]; }
+        const PortSpec& timing_port(size_t timing) const { return timing_ports_[timing]; }
+
+    protected:
+        FlatStructure();
+        ~FlatStructure() = default;
+
+        void set_header(const Header& header) { header_ = header; }
+
+        //Reserves space for the structure of delayfile, returning its sizes
+        //(so derived classes can reserve space for the values)
+        FlatSizes reserve_structure(const DelayFile& delayfile);
+
+        //Appends the structure of the cell (after the values of its IOPATHs
+        //and timing checks have been added)
+        void add_structure(const Cell& cell, Symbol instance); //instance is the cell's (interned) instance
+
+    protected:
+        Header header_;
+        std::shared_ptr<const SymbolTable> symbols_;
+
+        std::vector<Symbol> celltypes_;
+        std::vector<Symbol> instances_;
+        std::vector<size_t> iopath_offsets_; //num_cells() + 1 entries
+        std::vector<size_t> timing_offsets_; //num_cells() + 1 entries
+
+        std::vector<PortSpec> iopath_inputs_;
+        std::vector<PortSpec> iopath_outputs_;
+
+        std::vector<TimingType> timing_types_;
+        std::vector<PortSpec> timing_clocks_;
+        std::vector<PortSpec> timing_ports_;
+};
+
+//A Loader which builds a File (derived from FlatStructure) directly as the
+//file is parsed, without building the intermediate DelayFile cells (see
+//FlatLoader, FixedLoader and PooledLoader)
+//
+//File must be a friend of the loader's, and provide set_header(), which
+//may throw std::invalid_argument (reported as a ParseError), and
+//add_cell(cell, instance).
+template<typename File>
+class FlatStructureLoader : public Loader {
+    protected:
+        //Each file loaded starts as a copy of empty_file (e.g. with its unit)
+        explicit FlatStructureLoader(File empty_file=File())
+            : empty_file_(empty_file)
+            , delayfile_(std::move(empty_file))
+            {}
+
+        void on_header(const Header& header) override {
+            //Start a new file, which shares the names being interned by the parser
+            delayfile_ = empty_file_;
+            delayfile_.symbols_ = symbols();
+            try {
+                delayfile_.set_header(header);
+            } catch(std::invalid_argument& error) {
+                throw ParseError(error.what(), current_location());
+            }
+        }
+
+        void on_cell(Cell&& cell) override {
+            add_cell(cell);
+        }
+
+        void add_cell(const Cell& cell) {
+            //The cell's values are stored in the file, so it need not be kept
+            delayfile_.add_cell(cell, intern_instance(cell));
+        }
+
+    private:
+        File empty_file_;
+
+    protected:
+        File delayfile_;
+};
+
+//A compact, structure-of-arrays representation of a DelayFile
+//
+//Values are stored column-wise, in arrays parallel to the FlatStructure's
+//(e.g. rise().min holds the minimum rise delay of every IOPATH), so passes
+//which sweep every arc read memory sequentially.
+//
+//A FlatDelayFile can be converted from a DelayFile, or built directly while
+//parsing with a FlatLoader.
+class FlatDelayFile : public FlatStructure {
+    public:
+        FlatDelayFile() = default;
+        explicit FlatDelayFile(const DelayFile& delayfile);
+
+        //IOPATH values
+        const TripleColumns& rise() const { return rise_; }
+        const TripleColumns& fall() const { return fall_; }
+
+        //Timing check values
+        const TripleColumns& timing_t() const { return timing_t_; }
+
+        //The values, for modification in place (their sizes must not be changed)
+        TripleColumns& mutable_rise() { return rise_; }
+        TripleColumns& mutable_fall() { return fall_; }
+        TripleColumns& mutable_timing_t() { return timing_t_; }
+
+    private:
+        friend class FlatStructureLoader<FlatDelayFile>;
+
+        void add_cell(const Cell& cell, Symbol instance); //instance is the cell's (interned) instance
+
+    private:
+        TripleColumns rise_;
+        TripleColumns fall_;
+        TripleColumns timing_t_;
+};
+
+//A Loader which builds a FlatDelayFile directly as the file is parsed
+//(without building the intermediate DelayFile cells).
+class FlatLoader : public FlatStructureLoader<FlatDelayFile> {
+    public:
+        const FlatDelayFile& get_flat_delayfile() const { return delayfile_; }
+};
+
+} //sdfparse
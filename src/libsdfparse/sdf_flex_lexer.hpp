@@ -0,0 +1,66 @@
+#pragma once
+
+#include <sstream>
+
+#include "sdf_lexer.hpp"
+
+/*
+ * Flex requires that yyFlexLexer is equivalent to
+ * the lexer class we are using, before we include
+ * FlexLexer.h.  See 'Generating C++ Scanners' in 
+ * the Flex manual.
+ */
+#if ! defined(yyFlexLexerOnce)
+
+#undef yyFlexLexer
+/*
+ * Flex doesn't support C++ namespaces, so
+ * it is faked using the '%option prefix' defined
+ * in sdf_scanner.l, for some reason Flex also prefixes
+ * the class name with Flex.
+ *
+ * So:
+ * %option prefix=SdfParse_
+ * %option yyclass=FlexSdfLexer
+ * becomes 'SdfParse_FlexLexer'
+ */
+#define yyFlexLexer SdfParse_FlexLexer
+#include <FlexLexer.h>
+
+#endif
+
+/*
+ * The YY_DECL is used by flex to specify the signature of the main
+ * lexer function.
+ *
+ * We re-define it to something reasonable
+ */
+#undef YY_DECL
+#define YY_DECL sdfparse::Parser::symbol_type sdfparse::FlexSdfLexer::next_token()
+
+namespace sdfparse {
+
+//A table-driven lexer generated by flex from sdf_lexer.l
+class FlexSdfLexer : public Lexer, private yyFlexLexer {
+    //We use private inheritance to hide the flex
+    //implementation details from anyone using FlexSdfLexer
+    public:
+        sdfparse::Parser::symbol_type next_token() override;
+
+        void set_input(std::istream& is) override;
+        void set_input(const char* begin, const char* end) override;
+
+    protected:
+        //Called by flex to refill its buffer
+        int LexerInput(char* buf, int max_size) override;
+
+    private:
+        //Current position and end of in-memory input (nullptr if lexing from a stream)
+        const char* input_pos_ = nullptr;
+        const char* input_end_ = nullptr;
+
+        //Placeholder stream used to reset flex's buffer for in-memory input
+        std::istringstream empty_stream_;
+};
+
+} //sdfparse
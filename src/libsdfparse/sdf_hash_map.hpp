@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sdfparse {
+
+//An insert-only hash map using open addressing (linear probing)
+//
+//Entries are stored inline in a single array (no per-entry allocation),
+//which is kept at most half full. A key equal to empty_key marks unused
+//slots; an entry with that key is kept in a separate slot, so any key can
+//be inserted.
+template<typename Key, typename Value, typename Hash=std::hash<Key>>
+class OpenHashMap {
+    public:
+        explicit OpenHashMap(Key empty_key=Key())
+            : empty_key_(empty_key)
+            {}
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        //Pre-sizes the table to hold num_entries without re-hashing
+        void reserve(size_t num_entries) {
+            size_t capacity = 16;
+            while(capacity < 2 * num_entries) {
+                capacity *= 2;
+            }
+            if(capacity > slots_.size()) {
+                rehash(capacity);
+            }
+        }
+
+        //Adds key (if not already present), returning true if it was added
+        bool insert(const Key& key, const Value& value) {
+            if(key == empty_key_) {
+                if(has_empty_key_entry_) {
+                    return false;
+                }
+                has_empty_key_entry_ = true;
+                empty_key_value_ = value;
+                ++size_;
+                return true;
+            }
+
+            if(2 * (size_ + 1) > slots_.size()) {
+                rehash(slots_.empty() ? 16 : 2 * slots_.size());
+            }
+
+            size_t i = slot_index(key);
+            while(!(slots_[i].key == empty_key_)) {
+                if(slots_[i].key == key) {
+                    return false;
+                }
+                i = (i + 1) & mask_;
+            }
+            slots_[i].key = key;
+            slots_[i].value = value;
+            ++size_;
+            return true;
+        }
+
+        //Returns the value for key, or nullptr if it is not present
+        const Value* find(const Key& key) const {
+            if(key == empty_key_) {
+                return has_empty_key_entry_ ? &empty_key_value_ : nullptr;
+            }
+            if(slots_.empty()) {
+                return nullptr;
+            }
+
+            size_t i = slot_index(key);
+            while(!(slots_[i].key == empty_key_)) {
+                if(slots_[i].key == key) {
+                    return &slots_[i].value;
+                }
+                i = (i + 1) & mask_;
+            }
+            return nullptr;
+        }
+
+    private:
+        struct Slot {
+            Key key;
+            Value value;
+        };
+
+        size_t slot_index(const Key& key) const {
+            //Fibonacci hashing spreads poor hashes (e.g. of pointers) across the table
+            uint64_t hash = static_cast<uint64_t>(Hash()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+            return static_cast<size_t>(hash >> shift_);
+        }
+
+        void rehash(size_t capacity) {
+            assert((capacity & (capacity - 1)) == 0);
+
+            std::vector<Slot> old_slots(capacity, Slot{empty_key_, Value()});
+            old_slots.swap(slots_);
+            mask_ = capacity - 1;
+            shift_ = 64;
+            for(size_t c = capacity; c > 1; c /= 2) {
+                --shift_;
+            }
+            size_ = has_empty_key_entry_ ? 1 : 0;
+
+            for(const Slot& slot : old_slots) {
+                if(!(slot.key == empty_key_)) {
+                    insert(slot.key, slot.value);
+                }
+            }
+        }
+
+    private:
+        Key empty_key_;
+        bool has_empty_key_entry_ = false;
+        Value empty_key_value_ = Value(); //The value of the entry for empty_key_ (if any)
+        std::vector<Slot> slots_;
+        size_t mask_ = 0;
+        unsigned shift_ = 64; //Selects the top log2(capacity) bits of the hash
+        size_t size_ = 0;
+};
+
+} //sdfparse
@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <functional>
+
+#include "sdf_index.hpp"
+
+namespace sdfparse {
+
+constexpr size_t DelayFileIndex::NO_CELL;
+
+void DelayFileIndex::build_once(const DelayFile& delayfile) {
+    std::call_once(build_flag_, &DelayFileIndex::build_impl, this, std::cref(delayfile));
+}
+
+void DelayFileIndex::build_impl(const DelayFile& delayfile) {
+    const auto& cells = delayfile.cells();
+
+    size_t num_iopaths = 0;
+    for(const Cell& cell : cells) {
+        num_iopaths += cell.delay().iopaths().size();
+    }
+    cells_.reserve(cells.size());
+    iopaths_.reserve(num_iopaths);
+
+    for(size_t icell = 0; icell < cells.size(); ++icell) {
+        const Cell& cell = cells[icell];
+
+        //Earlier cells take precedence for repeated instances
+        cells_.insert(key_of(cell.instance()), icell);
+
+        for(const Iopath& iopath : cell.delay().iopaths()) {
+            Symbol input = iopath.input().port_symbol();
+            Symbol output = iopath.output().port_symbol();
+            ports_.insert(key_of(input.str()), input);
+            ports_.insert(key_of(output.str()), output);
+
+            IopathKey key = {icell, input, output, iopath.input().condition()};
+            iopaths_.insert(key, &iopath);
+        }
+    }
+
+    built_.store(true, std::memory_order_release);
+}
+
+size_t DelayFileIndex::find_cell(const std::string& instance) const {
+    const size_t* icell = cells_.find(key_of(instance));
+    return (icell) ? *icell : NO_CELL;
+}
+
+const Iopath* DelayFileIndex::find_iopath(size_t icell, const std::string& input, const std::string& output,
+                                          PortCondition condition) const {
+    //Names which no IOPATH uses can not match
+    const Symbol* input_symbol = ports_.find(key_of(input));
+    const Symbol* output_symbol = ports_.find(key_of(output));
+    if(!input_symbol || !output_symbol) {
+        return nullptr;
+    }
+
+    IopathKey key = {icell, *input_symbol, *output_symbol, condition};
+    const Iopath* const* iopath = iopaths_.find(key);
+    return (iopath) ? *iopath : nullptr;
+}
+
+size_t DelayFileIndex::StringKeyHash::operator()(const StringKey& key) const {
+    //FNV-1a (the map mixes the result further)
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for(size_t i = 0; i < key.size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(key.data[i])) * UINT64_C(0x100000001b3);
+    }
+    return static_cast<size_t>(hash);
+}
+
+size_t DelayFileIndex::IopathKeyHash::operator()(const IopathKey& key) const {
+    size_t hash = std::hash<size_t>()(key.icell);
+    hash = hash * 31 + std::hash<Symbol>()(key.input);
+    hash = hash * 31 + std::hash<Symbol>()(key.output);
+    hash = hash * 31 + static_cast<size_t>(key.condition);
+    return hash;
+}
+
+} //sdfparse
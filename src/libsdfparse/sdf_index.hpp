@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "sdf_data.hpp"
+#include "sdf_hash_map.hpp"
+
+namespace sdfparse {
+
+//Lookup tables for the cells and IOPATHs of a DelayFile
+//
+//The index is built on first use by DelayFile (see DelayFile::find_cell()).
+//Once built it is immutable, and lookups take no locks: instances and port
+//names are looked up by their contents in the index's own tables (which
+//refer to the DelayFile's interned strings), rather than through the
+//DelayFile's SymbolTable.
+class DelayFileIndex {
+    public:
+        static constexpr size_t NO_CELL = size_t(-1);
+
+        //Builds the index for delayfile (once; later calls do nothing)
+        void build(const DelayFile& delayfile) {
+            if(!built_.load(std::memory_order_acquire)) {
+                build_once(delayfile);
+            }
+        }
+
+        //Returns the index of the (first) cell for instance, or NO_CELL
+        size_t find_cell(const std::string& instance) const;
+
+        //Returns the IOPATH from input to output of the cell with index
+        //icell, or nullptr if there is none
+        const Iopath* find_iopath(size_t icell, const std::string& input, const std::string& output,
+                                  PortCondition condition) const;
+
+        size_t num_cells() const { return cells_.size(); }
+        size_t num_iopaths() const { return iopaths_.size(); }
+
+    private:
+        void build_once(const DelayFile& delayfile);
+        void build_impl(const DelayFile& delayfile);
+
+        //A string compared (and hashed) by its contents
+        struct StringKey {
+            const char* data;
+            size_t size;
+
+            friend bool operator==(const StringKey& lhs, const StringKey& rhs) {
+                return lhs.size == rhs.size
+                       && (lhs.data == nullptr) == (rhs.data == nullptr)
+                       && (lhs.size == 0 || std::memcmp(lhs.data, rhs.data, lhs.size) == 0);
+            }
+        };
+
+        struct StringKeyHash {
+            size_t operator()(const StringKey& key) const;
+        };
+
+        static StringKey key_of(const std::string& str) { return StringKey{str.data(), str.size()}; }
+
+        struct IopathKey {
+            size_t icell;
+            Symbol input;
+            Symbol output;
+            PortCondition condition;
+
+            friend bool operator==(const IopathKey& lhs, const IopathKey& rhs) {
+                return lhs.icell == rhs.icell
+                       && lhs.input == rhs.input
+                       && lhs.output == rhs.output
+                       && lhs.condition == rhs.condition;
+            }
+        };
+
+        struct IopathKeyHash {
+            size_t operator()(const IopathKey& key) const;
+        };
+
+    private:
+        std::once_flag build_flag_;
+        std::atomic<bool> built_{false}; //Set (with release) once build_impl() has completed
+        OpenHashMap<StringKey, size_t, StringKeyHash> cells_{StringKey{nullptr, 0}};
+        OpenHashMap<StringKey, Symbol, StringKeyHash> ports_{StringKey{nullptr, 0}}; //Port names used by IOPATHs
+        OpenHashMap<IopathKey, const Iopath*, IopathKeyHash> iopaths_{IopathKey{NO_CELL, Symbol(), Symbol(), PortCondition::NONE}};
+};
+
+} //sdfparse
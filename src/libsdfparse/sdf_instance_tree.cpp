@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "sdf_instance_tree.hpp"
+#include "sdf_parallel.hpp"
+
+namespace /*anonymous*/ {
+
+//Number of instances split by each parallel work item
+constexpr size_t INSTANCES_PER_BLOCK = 4096;
+
+//Minimum number of items in each initially sorted run
+constexpr size_t MIN_ITEMS_PER_RUN = 16384;
+
+template<typename Func>
+void for_each_segment(const std::string& path, const std::string& divider, const Func& func);
+
+template<typename Less>
+void parallel_sort(std::vector<size_t>& items, const Less& less, size_t num_threads);
+
+//Calls func(segment) for each of the divider separated segments of path
+//(of which the empty path has none)
+template<typename Func>
+void for_each_segment(const std::string& path, const std::string& divider, const Func& func) {
+    if(path.empty()) {
+        return;
+    }
+    if(divider.empty()) {
+        func(std::string(path));
+        return;
+    }
+
+    size_t begin = 0;
+    while(true) {
+        size_t end = path.find(divider, begin);
+        if(end == std::string::npos) {
+            func(path.substr(begin));
+            return;
+        }
+        func(path.substr(begin, end - begin));
+        begin = end + divider.size();
+    }
+}
+
+//Sorts items by sorting runs in parallel, and then merging pairs of runs
+//(in parallel) until one remains
+template<typename Less>
+void parallel_sort(std::vector<size_t>& items, const Less& less, size_t num_threads) {
+    if(num_threads == 0) {
+        num_threads = sdfparse::default_num_threads();
+    }
+    size_t num_runs = std::max<size_t>(1, std::min(num_threads, items.size() / MIN_ITEMS_PER_RUN));
+
+    std::vector<size_t> bounds; //Run i is items[bounds[i], bounds[i + 1])
+    for(size_t i = 0; i <= num_runs; ++i) {
+        bounds.push_back(i * items.size() / num_runs);
+    }
+
+    sdfparse::parallel_for(num_runs, num_threads, [&](size_t i) {
+        std::sort(items.begin() + bounds[i], items.begin() + bounds[i + 1], less);
+    });
+
+    std::vector<size_t> merged(items.size());
+    while(bounds.size() > 2) {
+        size_t num_merges = bounds.size() / 2; //The last run is copied if there are an odd number
+        sdfparse::parallel_for(num_merges, num_threads, [&](size_t i) {
+            size_t begin = bounds[2 * i];
+            size_t mid = bounds[std::min(2 * i + 1, bounds.size() - 1)];
+            size_t end = bounds[std::min(2 * i + 2, bounds.size() - 1)];
+            std::merge(items.begin() + begin, items.begin() + mid,
+                       items.begin() + mid, items.begin() + end,
+                       merged.begin() + begin, less);
+        });
+        items.swap(merged);
+
+        std::vector<size_t> merged_bounds;
+        for(size_t i = 0; i < bounds.size(); i += 2) {
+            merged_bounds.push_back(bounds[i]);
+        }
+        if(merged_bounds.back() != bounds.back()) {
+            merged_bounds.push_back(bounds.back());
+        }
+        bounds.swap(merged_bounds);
+    }
+}
+
+} //namespace
+
+namespace sdfparse {
+
+constexpr InstanceTree::NodeId InstanceTree::NO_NODE;
+constexpr size_t InstanceTree::NO_CELL;
+
+//Each cell's instance as a sequence of segments
+struct InstanceTree::Paths {
+    std::vector<size_t> offsets; //Cell i's segments are segments[offsets[i], offsets[i + 1])
+    std::vector<Symbol> segments;
+
+    size_t size(size_t cell) const { return offsets[cell + 1] - offsets[cell]; }
+    Symbol segment(size_t cell, size_t i) const { return segments[offsets[cell] + i]; }
+
+    //Orders cells by their segments (and then by index), so that each
+    //path directly precedes those below it
+    bool operator()(size_t lhs, size_t rhs) const {
+        size_t lhs_size = size(lhs);
+        size_t rhs_size = size(rhs);
+        for(size_t i = 0; i < lhs_size && i < rhs_size; ++i) {
+            Symbol lhs_segment = segment(lhs, i);
+            Symbol rhs_segment = segment(rhs, i);
+            if(lhs_segment != rhs_segment) {
+                return lhs_segment.str() < rhs_segment.str();
+            }
+        }
+        if(lhs_size != rhs_size) {
+            return lhs_size < rhs_size;
+        }
+        return lhs < rhs;
+    }
+};
+
+InstanceTree::InstanceTree()
+    : divider_(Header().divider())
+    , segments_(std::make_shared<SymbolTable>()) {
+    build(std::vector<Symbol>(), 1);
+}
+
+InstanceTree::InstanceTree(const DelayFile& delayfile, size_t num_threads)
+    : divider_(delayfile.header().divider())
+    , segments_(std::make_shared<SymbolTable>()) {
+    std::vector<Symbol> instances;
+    instances.reserve(delayfile.cells().size());
+    for(const Cell& cell : delayfile.cells()) {
+        instances.push_back(cell.instance_symbol());
+    }
+    build(instances, num_threads);
+}
+
+InstanceTree::InstanceTree(const FlatDelayFile& flat_delayfile, size_t num_threads)
+    : divider_(flat_delayfile.header().divider())
+    , segments_(std::make_shared<SymbolTable>()) {
+    std::vector<Symbol> instances;
+    instances.reserve(flat_delayfile.num_cells());
+    for(size_t cell = 0; cell < flat_delayfile.num_cells(); ++cell) {
+        instances.push_back(flat_delayfile.instance(cell));
+    }
+    build(instances, num_threads);
+}
+
+InstanceTree::InstanceTree(const std::vector<Symbol>& instances, const std::string& divider, size_t num_threads)
+    : divider_(divider)
+    , segments_(std::make_shared<SymbolTable>()) {
+    build(instances, num_threads);
+}
+
+size_t InstanceTree::find_cell(const std::string& instance) const {
+    bool exact = false;
+    NodeId node = locate(instance, exact);
+    if(node == NO_NODE || !exact) {
+        return NO_CELL;
+    }
+    ArrayView<size_t> node_cells = own_cells(node);
+    return (node_cells.empty()) ? NO_CELL : node_cells.front();
+}
+
+ArrayView<size_t> InstanceTree::cells_under(const std::string& prefix) const {
+    NodeId node = find_node(prefix);
+    return (node != NO_NODE) ? cells(node) : ArrayView<size_t>();
+}
+
+InstanceTree::NodeId InstanceTree::find_node(const std::string& prefix) const {
+    bool exact = false;
+    return locate(prefix, exact);
+}
+
+std::vector<InstanceTree::NodeId> InstanceTree::children(NodeId node) const {
+    //Each child's subtree directly follows the previous child's
+    std::vector<NodeId> node_children;
+    for(NodeId child = node + 1; child < nodes_[node].subtree_end; child = nodes_[child].subtree_end) {
+        node_children.push_back(child);
+    }
+    return node_children;
+}
+
+ArrayView<Symbol> InstanceTree::label(NodeId node) const {
+    const Node& n = nodes_[node];
+    size_t parent_depth = (n.parent != NO_NODE) ? nodes_[n.parent].depth : 0;
+    return ArrayView<Symbol>(labels_.data() + n.label_begin, n.depth - parent_depth);
+}
+
+std::string InstanceTree::path(NodeId node) const {
+    std::vector<NodeId> ancestors;
+    for(NodeId ancestor = node; ancestor != NO_NODE; ancestor = nodes_[ancestor].parent) {
+        ancestors.push_back(ancestor);
+    }
+
+    std::string node_path;
+    bool first = true;
+    for(auto iter = ancestors.rbegin(); iter != ancestors.rend(); ++iter) {
+        for(Symbol segment : label(*iter)) {
+            if(!first) {
+                node_path += divider_;
+            }
+            node_path += segment.str();
+            first = false;
+        }
+    }
+    return node_path;
+}
+
+ArrayView<size_t> InstanceTree::cells(NodeId node) const {
+    const Node& n = nodes_[node];
+    return ArrayView<size_t>(cells_.data() + n.cell_begin, n.cell_end - n.cell_begin);
+}
+
+ArrayView<size_t> InstanceTree::own_cells(NodeId node) const {
+    const Node& n = nodes_[node];
+    return ArrayView<size_t>(cells_.data() + n.cell_begin, n.own_end - n.cell_begin);
+}
+
+size_t InstanceTree::ChildKeyHash::operator()(const ChildKey& key) const {
+    return std::hash<NodeId>()(key.parent) * 31 + std::hash<Symbol>()(key.segment);
+}
+
+void InstanceTree::build(const std::vector<Symbol>& instances, size_t num_threads) {
+    //A tree has at most two nodes per cell
+    if(instances.size() >= NO_NODE / 2) {
+        throw std::length_error("Too many instances for InstanceTree");
+    }
+
+    //Split (and intern) the instances in parallel, with each block's
+    //segments gathered separately
+    Paths paths;
+    paths.offsets.resize(instances.size() + 1, 0);
+
+    size_t num_blocks = (instances.size() + INSTANCES_PER_BLOCK - 1) / INSTANCES_PER_BLOCK;
+    std::vector<std::vector<Symbol>> block_segments(num_blocks);
+    parallel_for(num_blocks, num_threads, [&](size_t block) {
+        size_t end = std::min(instances.size(), (block + 1) * INSTANCES_PER_BLOCK);
+        for(size_t i = block * INSTANCES_PER_BLOCK; i < end; ++i) {
+            size_t num_segments = 0;
+            for_each_segment(instances[i].str(), divider_, [&](std::string&& segment) {
+                block_segments[block].push_back(segments_->intern(std::move(segment)));
+                ++num_segments;
+            });
+            paths.offsets[i + 1] = num_segments;
+        }
+    });
+
+    std::partial_sum(paths.offsets.begin(), paths.offsets.end(), paths.offsets.begin());
+    paths.segments.resize(paths.offsets.back());
+    parallel_for(num_blocks, num_threads, [&](size_t block) {
+        std::copy(block_segments[block].begin(), block_segments[block].end(),
+                  paths.segments.begin() + paths.offsets[block * INSTANCES_PER_BLOCK]);
+    });
+    block_segments.clear();
+
+    //Sorting the paths puts each subtree's cells together, in pre-order
+    cells_.resize(instances.size());
+    std::iota(cells_.begin(), cells_.end(), 0);
+    parallel_sort(cells_, [&paths](size_t lhs, size_t rhs) { return paths(lhs, rhs); }, num_threads);
+
+    nodes_.clear();
+    labels_.clear();
+    children_ = OpenHashMap<ChildKey, NodeId, ChildKeyHash>(ChildKey{NO_NODE, Symbol()});
+    children_.reserve(instances.size());
+
+    Node root_node = {NO_NODE, 0, 0, 0, 0, 0, cells_.size()};
+    nodes_.push_back(root_node);
+    build_subtree(root(), 0, cells_.size(), paths);
+}
+
+//Adds the subtree below node, whose cells are cells_[begin, end)
+void InstanceTree::build_subtree(NodeId node, size_t begin, size_t end, const Paths& paths) {
+    size_t node_depth = nodes_[node].depth;
+
+    //Cells at the node come first
+    size_t i = begin;
+    while(i < end && paths.size(cells_[i]) == node_depth) {
+        ++i;
+    }
+    nodes_[node].own_end = i;
+
+    //Each child holds a run of cells with the same next segment
+    while(i < end) {
+        Symbol segment = paths.segment(cells_[i], node_depth);
+        size_t run_end = i + 1;
+        while(run_end < end && paths.segment(cells_[run_end], node_depth) == segment) {
+            ++run_end;
+        }
+
+        //Since the cells are sorted, the segments shared by the run are
+        //those shared by its first and last cells (which is at most the
+        //length of any path in the run)
+        size_t first = cells_[i];
+        size_t last = cells_[run_end - 1];
+        size_t child_depth = node_depth + 1;
+        size_t max_depth = std::min(paths.size(first), paths.size(last));
+        while(child_depth < max_depth && paths.segment(first, child_depth) == paths.segment(last, child_depth)) {
+            ++child_depth;
+        }
+
+        NodeId child = static_cast<NodeId>(nodes_.size());
+        Node child_node = {node, static_cast<uint32_t>(child_depth), labels_.size(), 0, i, i, run_end};
+        nodes_.push_back(child_node);
+        for(size_t depth = node_depth; depth < child_depth; ++depth) {
+            labels_.push_back(paths.segment(first, depth));
+        }
+        children_.insert(ChildKey{node, segment}, child);
+
+        build_subtree(child, i, run_end, paths);
+        i = run_end;
+    }
+    nodes_[node].subtree_end = static_cast<NodeId>(nodes_.size());
+}
+
+InstanceTree::NodeId InstanceTree::locate(const std::string& path, bool& exact) const {
+    exact = false;
+
+    //Segments which were never interned can not match
+    std::vector<Symbol> query;
+    bool known = true;
+    for_each_segment(path, divider_, [&](std::string&& segment) {
+        Symbol symbol = segments_->find(segment);
+        known = known && !symbol.is_null();
+        query.push_back(symbol);
+    });
+    if(!known) {
+        return NO_NODE;
+    }
+
+    NodeId node = root();
+    size_t i = 0;
+    while(i < query.size()) {
+        const NodeId* child = children_.find(ChildKey{node, query[i]});
+        if(!child) {
+            return NO_NODE;
+        }
+        node = *child;
+
+        ArrayView<Symbol> node_label = label(node);
+        for(size_t j = 0; j < node_label.size(); ++j, ++i) {
+            if(i == query.size()) {
+                return node; //Ends within the node's label
+            }
+            if(node_label[j] != query[i]) {
+                return NO_NODE;
+            }
+        }
+    }
+    exact = true;
+    return node;
+}
+
+} //sdfparse
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdf_array_view.hpp"
+#include "sdf_data.hpp"
+#include "sdf_flat.hpp"
+#include "sdf_hash_map.hpp"
+#include "sdf_symbol.hpp"
+
+namespace sdfparse {
+
+//A hierarchy index over the instances of a file's cells
+//
+//Instance paths are split into segments at the header's divider() (e.g.
+//"dut/u_core/reg_0" has segments "dut", "u_core" and "reg_0"), and stored as
+//a compressed trie: each node is labelled with one or more segments (chains
+//of single-child nodes are merged), and each distinct segment is stored once.
+//
+//Nodes are numbered in pre-order and the cells are kept in the same order,
+//so all the cells under a hierarchy prefix are a single contiguous range.
+//Finding a prefix (or an exact instance) takes one hash lookup per segment,
+//after which its cells and their count are available directly.
+//
+//Cells are identified by their index in the file (e.g. DelayFile::cells()).
+//Escaped dividers are not distinguished, since instance names are stored
+//unescaped.
+class InstanceTree {
+    public:
+        typedef uint32_t NodeId;
+
+        static constexpr NodeId NO_NODE = NodeId(-1);
+        static constexpr size_t NO_CELL = size_t(-1);
+
+        //An empty tree
+        InstanceTree();
+
+        //Builds the tree for the cells' instances using up to num_threads
+        //threads (0 uses one per hardware thread)
+        explicit InstanceTree(const DelayFile& delayfile, size_t num_threads=0);
+        explicit InstanceTree(const FlatDelayFile& flat_delayfile, size_t num_threads=0);
+
+        //As above for arbitrary instances (with cell i named instances[i])
+        InstanceTree(const std::vector<Symbol>& instances, const std::string& divider, size_t num_threads=0);
+
+        const std::string& divider() const { return divider_; }
+        size_t num_cells() const { return cells_.size(); }
+        size_t num_nodes() const { return nodes_.size(); }
+
+        //Returns the index of the (first) cell for instance, or NO_CELL
+        size_t find_cell(const std::string& instance) const;
+
+        //Returns the (cell indices of) the cells whose instance is prefix or
+        //is below it in the hierarchy. Prefixes consist of whole segments
+        //(e.g. "dut/u_core" does not include "dut/u_core2/reg_0"), and the
+        //empty prefix includes all cells.
+        ArrayView<size_t> cells_under(const std::string& prefix) const;
+
+        //Returns the number of cells in cells_under(prefix)
+        size_t count_under(const std::string& prefix) const { return cells_under(prefix).size(); }
+
+        //Returns the node whose subtree holds exactly the cells under prefix
+        //(the node may be deeper than prefix if its label was merged), or
+        //NO_NODE if there are no such cells
+        NodeId find_node(const std::string& prefix) const;
+
+        //Nodes
+        NodeId root() const { return 0; }
+        NodeId parent(NodeId node) const { return nodes_[node].parent; } //NO_NODE for the root
+        std::vector<NodeId> children(NodeId node) const;
+        size_t depth(NodeId node) const { return nodes_[node].depth; } //Segments in the node's path
+        ArrayView<Symbol> label(NodeId node) const; //Segments after the parent's path
+        std::string path(NodeId node) const; //Joined with divider()
+
+        //The cells at or below the node
+        ArrayView<size_t> cells(NodeId node) const;
+
+        //The cells whose instance is the node's path (in file order)
+        ArrayView<size_t> own_cells(NodeId node) const;
+
+    private:
+        struct Node {
+            NodeId parent;
+            uint32_t depth;
+            size_t label_begin; //The label is labels_[label_begin, label_begin + depth - parent's depth)
+            NodeId subtree_end; //One past the last node in the subtree (nodes are in pre-order)
+            size_t cell_begin; //The subtree's cells are cells_[cell_begin, cell_end)...
+            size_t own_end; //...of which cells_[cell_begin, own_end) are at this node
+            size_t cell_end;
+        };
+
+        struct ChildKey {
+            NodeId parent;
+            Symbol segment; //The first segment of the child's label
+
+            friend bool operator==(const ChildKey& lhs, const ChildKey& rhs) {
+                return lhs.parent == rhs.parent && lhs.segment == rhs.segment;
+            }
+        };
+
+        struct ChildKeyHash {
+            size_t operator()(const ChildKey& key) const;
+        };
+
+        struct Paths; //The split instances, while building
+
+        void build(const std::vector<Symbol>& instances, size_t num_threads);
+        void build_subtree(NodeId node, size_t begin, size_t end, const Paths& paths);
+
+        //Returns the node for path (as find_node()), setting exact if the
+        //path ends at the node rather than within its label
+        NodeId locate(const std::string& path, bool& exact) const;
+
+    private:
+        std::string divider_;
+        std::shared_ptr<SymbolTable> segments_;
+        std::vector<Node> nodes_;
+        std::vector<Symbol> labels_;
+        std::vector<size_t> cells_; //Cell indices in tree order
+        OpenHashMap<ChildKey, NodeId, ChildKeyHash> children_{ChildKey{NO_NODE, Symbol()}};
+};
+
+} //sdfparse
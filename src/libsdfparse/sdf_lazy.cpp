@@ -0,0 +1,190 @@
+#include <cassert>
+
+#include "sdf_lazy.hpp"
+#include "sdf_chunker.hpp"
+#include "sdf_decompress.hpp"
+#include "sdf_escape.hpp"
+#include "sdf_lexer.hpp"
+
+namespace /*anonymous*/ {
+
+sdfparse::Symbol intern_name(sdfparse::SymbolTable& symbols, const char* begin, const char* end);
+
+//Interns the name with the (raw) text [begin, end), after unescaping it as the parser would
+sdfparse::Symbol intern_name(sdfparse::SymbolTable& symbols, const char* begin, const char* end) {
+    std::string name(begin, end);
+    unescape_sdf_identifier_in_place(name);
+    return symbols.intern(std::move(name));
+}
+
+} //namespace
+
+namespace sdfparse {
+
+constexpr size_t LazyDelayFile::NO_CELL;
+
+LazyDelayFile::LazyDelayFile(LexerType lexer_type)
+    : loader_(new Loader()) {
+    loader_->set_lexer_type(lexer_type);
+    loader_->set_cell_storage(CellStorage::ARENA);
+    close();
+}
+
+LazyDelayFile::~LazyDelayFile()
+    {}
+
+void LazyDelayFile::open(const std::string& filename) {
+    close();
+    filename_ = filename;
+
+    auto pos = position(&filename_);
+    //The index scan reads the whole file in order
+    if(!mapped_file_.open(filename_, AccessPattern::SEQUENTIAL)) {
+        throw ParseError("Failed to open file", location(pos, pos));
+    }
+    if(detect_compression(mapped_file_.begin(), mapped_file_.size()) != Compression::NONE) {
+        throw ParseError("Compressed files can not be loaded lazily", location(pos, pos));
+    }
+
+    const char* begin = mapped_file_.begin();
+    const char* end = mapped_file_.end();
+    Lexer& lexer = *loader_->lexer_;
+
+    //Find the cells
+    TextChunk header;
+    std::vector<size_t> unnamed_cells; //Cells whose names must be parsed
+    bool scanned = scan_sdf_cells(begin, end, header, [&](const CellText& text) {
+        CellEntry entry = {text.text.begin, text.text.end, text.text.line, text.text.column, Symbol(), Symbol()};
+        if(text.instance_begin) {
+            entry.celltype = intern_name(*symbols_, text.celltype_begin, text.celltype_end);
+            entry.instance = intern_name(*symbols_, text.instance_begin, text.instance_end);
+        } else {
+            unnamed_cells.push_back(cells_.size());
+        }
+        cells_.push_back(entry);
+    });
+
+    if(!scanned) {
+        //Parse the whole file to find the error
+        lexer.set_input(begin, end);
+        try {
+            loader_->run_parser(location(pos, pos), Fragment::WHOLE_FILE);
+        } catch(...) {
+            lexer.set_input(nullptr, nullptr);
+            throw;
+        }
+        lexer.set_input(nullptr, nullptr);
+        throw ParseError("Unexpected SDF file structure", location(pos, pos));
+    }
+
+    //Parse the header
+    lexer.set_input(header.begin, header.end);
+    try {
+        loader_->run_parser(location(pos, pos), Fragment::HEADER);
+    } catch(...) {
+        lexer.set_input(nullptr, nullptr);
+        throw;
+    }
+    lexer.set_input(nullptr, nullptr);
+    header_ = std::move(loader_->header_);
+
+    //Cells are then parsed on demand, in any order
+    mapped_file_.advise(AccessPattern::RANDOM);
+
+    parsed_.reset(new std::atomic<const Cell*>[cells_.size()]);
+    for(size_t icell = 0; icell < cells_.size(); ++icell) {
+        parsed_[icell].store(nullptr, std::memory_order_relaxed);
+    }
+
+    //Cells whose names could not be read directly are parsed now
+    for(size_t icell : unnamed_cells) {
+        const Cell& parsed_cell = cell(icell);
+        cells_[icell].celltype = parsed_cell.celltype_symbol();
+        cells_[icell].instance = parsed_cell.instance_symbol();
+    }
+
+    instances_.reserve(cells_.size());
+    for(size_t icell = 0; icell < cells_.size(); ++icell) {
+        //Earlier cells take precedence for repeated instances
+        instances_.insert(cells_[icell].instance, icell);
+    }
+}
+
+void LazyDelayFile::close() {
+    std::lock_guard<std::mutex> lock(parse_mutex_);
+
+    mapped_file_.close();
+    header_ = Header();
+    cells_.clear();
+    cells_.shrink_to_fit();
+    instances_ = OpenHashMap<Symbol, size_t>();
+    parsed_.reset();
+    parsed_cells_.clear();
+
+    symbols_ = std::make_shared<SymbolTable>();
+    arena_ = std::make_shared<Arena>();
+    loader_->symbols_ = symbols_;
+    loader_->arena_ = arena_;
+}
+
+size_t LazyDelayFile::find_cell_index(const std::string& instance) const {
+    Symbol symbol = symbols_->find(instance);
+    if(symbol.is_null()) {
+        return NO_CELL;
+    }
+    const size_t* icell = instances_.find(symbol);
+    return (icell) ? *icell : NO_CELL;
+}
+
+const Cell& LazyDelayFile::cell(size_t icell) {
+    assert(icell < cells_.size());
+
+    const Cell* parsed_cell = parsed_[icell].load(std::memory_order_acquire);
+    if(!parsed_cell) {
+        std::lock_guard<std::mutex> lock(parse_mutex_);
+
+        //Another thread may have parsed it while we waited
+        parsed_cell = parsed_[icell].load(std::memory_order_relaxed);
+        if(!parsed_cell) {
+            parsed_cell = parse_cell(cells_[icell]);
+            parsed_[icell].store(parsed_cell, std::memory_order_release);
+        }
+    }
+    return *parsed_cell;
+}
+
+const Cell* LazyDelayFile::find_cell(const std::string& instance) {
+    size_t icell = find_cell_index(instance);
+    return (icell != NO_CELL) ? &cell(icell) : nullptr;
+}
+
+size_t LazyDelayFile::num_parsed_cells() const {
+    std::lock_guard<std::mutex> lock(parse_mutex_);
+    return parsed_cells_.size();
+}
+
+const Cell* LazyDelayFile::parse_cell(const CellEntry& entry) {
+    Lexer& lexer = *loader_->lexer_;
+    lexer.set_input(entry.begin, entry.end);
+
+    //The cell's lists are copied into arena_ (shared with loader_)
+    auto pos = position(&filename_, entry.line, entry.column);
+    bool success = false;
+    try {
+        success = loader_->run_parser(location(pos, pos), Fragment::CELLS);
+    } catch(...) {
+        lexer.set_input(nullptr, nullptr);
+        throw;
+    }
+    lexer.set_input(nullptr, nullptr);
+
+    if(!success || loader_->cells_.size() != 1) {
+        throw ParseError("Failed to parse cell", location(pos, pos));
+    }
+
+    parsed_cells_.push_back(loader_->cells_[0]);
+    loader_->cells_.clear();
+    return &parsed_cells_.back();
+}
+
+} //sdfparse
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_error.hpp"
+#include "sdf_hash_map.hpp"
+#include "sdf_loader.hpp"
+#include "sdf_mmap.hpp"
+
+namespace sdfparse {
+
+//An SDF file whose cells are parsed on demand
+//
+//open() memory-maps the file, parses its header, and quickly scans for the
+//top-level CELLs, recording where each is along with its CELLTYPE and
+//INSTANCE (read directly from the text). A cell's body is only parsed the
+//first time it is accessed, after which the result is cached. This makes
+//querying a few cells of a large file much faster than loading it all.
+//
+//The file must remain unchanged while it is open. Errors (including those
+//in cell bodies, which are only found when the cell is accessed) are thrown
+//as ParseError. Cells may be accessed concurrently from multiple threads.
+class LazyDelayFile {
+    public:
+        static constexpr size_t NO_CELL = size_t(-1);
+
+        explicit LazyDelayFile(LexerType lexer_type=LexerType::FAST);
+        ~LazyDelayFile();
+
+        LazyDelayFile(const LazyDelayFile&) = delete;
+        LazyDelayFile& operator=(const LazyDelayFile&) = delete;
+
+        //Opens the (uncompressed) file, indexing its cells
+        void open(const std::string& filename);
+        void close();
+
+        const Header& header() const { return header_; }
+        const SymbolTable& symbols() const { return *symbols_; }
+
+        size_t num_cells() const { return cells_.size(); }
+        Symbol celltype(size_t icell) const { return cells_[icell].celltype; }
+        Symbol instance(size_t icell) const { return cells_[icell].instance; }
+
+        //Returns the index of the (first) cell for instance, or NO_CELL
+        size_t find_cell_index(const std::string& instance) const;
+
+        //Returns the cell, parsing it if required
+        const Cell& cell(size_t icell);
+
+        //Returns the (first) cell for instance (parsing it if required),
+        //or nullptr if there is none
+        const Cell* find_cell(const std::string& instance);
+
+        //The number of cells which have been parsed
+        size_t num_parsed_cells() const;
+
+    private:
+        //Where a cell is in the file
+        struct CellEntry {
+            const char* begin;
+            const char* end;
+            unsigned line;
+            unsigned column;
+            Symbol celltype;
+            Symbol instance;
+        };
+
+        //Parses the cell's text, returning the parsed cell (owned by parsed_cells_)
+        const Cell* parse_cell(const CellEntry& entry);
+
+    private:
+        std::string filename_;
+        MappedFile mapped_file_;
+        Header header_;
+        std::vector<CellEntry> cells_;
+        OpenHashMap<Symbol, size_t> instances_; //Instance -> cell index
+
+        std::shared_ptr<SymbolTable> symbols_;
+        std::shared_ptr<Arena> arena_; //Storage for the lists of parsed cells
+
+        //The parsed cell (if any) for each cell, published once parsed
+        std::unique_ptr<std::atomic<const Cell*>[]> parsed_;
+
+        mutable std::mutex parse_mutex_; //Serializes parsing (loader_, parsed_cells_ and arena_)
+        std::unique_ptr<Loader> loader_; //Parses cell bodies
+        std::deque<Cell> parsed_cells_; //Parsed cells (with stable addresses)
+};
+
+} //sdfparse
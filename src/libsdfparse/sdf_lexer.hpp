@@ -1,40 +1,12 @@
 #pragma once
 
-#include "sdf_parser.gen.hpp"
-
-/*
- * Flex requires that yyFlexLexer is equivalent to
- * the lexer class we are using, before we include
- * FlexLexer.h.  See 'Generating C++ Scanners' in 
- * the Flex manual.
- */
-#if ! defined(yyFlexLexerOnce)
-
-#undef yyFlexLexer
-/*
- * Flex doesn't support C++ namespaces, so
- * it is faked using the '%option prefix' defined
- * in sdf_scanner.l, for some reason Flex also prefixes
- * the class name with Flex.
- *
- * So:
- * %option prefix=SdfParse_
- * %option yyclass=Lexer
- * becomes 'SdfParse_FlexLexer'
- */
-#define yyFlexLexer SdfParse_FlexLexer
-#include <FlexLexer.h>
-
-#endif
+#include <algorithm>
+#include <iosfwd>
+#include <chrono>
+#include <utility>
+#include <vector>
 
-/*
- * The YY_DECL is used by flex to specify the signature of the main
- * lexer function.
- *
- * We re-define it to something reasonable
- */
-#undef YY_DECL
-#define YY_DECL sdfparse::Parser::symbol_type sdfparse::Lexer::next_token()
+#include "sdf_parser.gen.hpp"
 
 /*
  * Bison generated location tracking
@@ -43,18 +15,124 @@
 
 namespace sdfparse {
 
-class Lexer : private yyFlexLexer {
-    //We use private inheritance to hide the flex
-    //implementation details from anyone using Lexer
+//The part of an SDF file being parsed
+enum class Fragment {
+    WHOLE_FILE, //A complete SDF file
+    HEADER,     //The start of a file, up to (but excluding) the first CELL
+    CELLS       //A sequence of complete top-level CELLs
+};
+
+//The interface between the parser and a lexer
+//
+//The parser pulls tokens by calling next_token(). Concrete
+//lexers (e.g. FlexSdfLexer, FastSdfLexer) differ only in how
+//they scan the input.
+class Lexer {
     public:
-        sdfparse::Parser::symbol_type next_token();
+        virtual ~Lexer() = default;
+
+        virtual sdfparse::Parser::symbol_type next_token() = 0;
+
+        //Returns next_token(), counting it by kind and timing the lexer
+        //
+        //Reading the clock costs about as much as lexing a token, so only
+        //one in LEX_TIME_SAMPLE_INTERVAL tokens is timed (see lex_time())
+        sdfparse::Parser::symbol_type next_counted_token() {
+            if(num_counted_++ % LEX_TIME_SAMPLE_INTERVAL != 0) {
+                return count(next_token());
+            }
+            auto start = std::chrono::steady_clock::now();
+            auto token = next_token();
+            sampled_lex_time_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ++num_sampled_;
+            return count(std::move(token));
+        }
 
-        using yyFlexLexer::switch_streams;
+        //Lex from the given stream
+        virtual void set_input(std::istream& is) = 0;
+
+        //Lex directly out of the memory range [begin, end), which
+        //must remain valid until lexing is complete
+        virtual void set_input(const char* begin, const char* end) = 0;
 
         location get_loc() { return loc_; }
         void set_loc(location& loc) { loc_ = loc; }
-    private:
+
+        //Sets the fragment the input is parsed as
+        void set_fragment(Fragment fragment) { fragment_ = fragment; }
+
+        //Returns the fragment whose start token has yet to be returned
+        //(WHOLE_FILE if none)
+        Fragment take_fragment() {
+            Fragment fragment = fragment_;
+            fragment_ = Fragment::WHOLE_FILE;
+            return fragment;
+        }
+
+        //Enables or disables counting tokens (see next_counted_token()),
+        //clearing the counts
+        void set_count_tokens(bool count) {
+            count_tokens_ = count;
+            token_counts_.clear();
+            num_counted_ = 0;
+            num_sampled_ = 0;
+            sampled_lex_time_ = 0.;
+        }
+        bool count_tokens() const { return count_tokens_; }
+
+        //The number of tokens counted of each kind (indexed by symbol kind)
+        const std::vector<size_t>& token_counts() const { return token_counts_; }
+
+        //The (estimated) time spent in counted calls to next_token(), in
+        //seconds, extrapolated from the sampled tokens less the cost of
+        //reading the clock
+        double lex_time() const {
+            if(num_sampled_ == 0) return 0.;
+            double sampled_time = sampled_lex_time_ - num_sampled_ * clock_overhead();
+            return std::max(sampled_time, 0.) * num_counted_ / num_sampled_;
+        }
+
+        //The number of bytes read from the input since it was set
+        size_t bytes_read() const { return bytes_read_; }
+
+    protected:
         location loc_; 
+        size_t bytes_read_ = 0;
+
+    private:
+        //Counts token by kind
+        sdfparse::Parser::symbol_type count(sdfparse::Parser::symbol_type&& token) {
+            size_t kind = token.type_get();
+            if(kind >= token_counts_.size()) {
+                token_counts_.resize(kind + 1, 0);
+            }
+            ++token_counts_[kind];
+            return std::move(token);
+        }
+
+        //The mean time (in seconds) between two consecutive reads of the clock
+        static double clock_overhead() {
+            static const double overhead = []() {
+                const int num_reads = 256;
+                auto start = std::chrono::steady_clock::now();
+                auto end = start;
+                for(int i = 0; i < num_reads; ++i) {
+                    end = std::chrono::steady_clock::now();
+                }
+                return std::chrono::duration<double>(end - start).count() / num_reads;
+            }();
+            return overhead;
+        }
+
+    private:
+        static constexpr size_t LEX_TIME_SAMPLE_INTERVAL = 64;
+
+        Fragment fragment_ = Fragment::WHOLE_FILE;
+        bool count_tokens_ = false;
+        std::vector<size_t> token_counts_;
+        size_t num_counted_ = 0; //Tokens returned by next_counted_token()
+        size_t num_sampled_ = 0; //Of which were timed
+        double sampled_lex_time_ = 0.; //Time spent lexing the sampled tokens
 };
 
 } //sdfparse
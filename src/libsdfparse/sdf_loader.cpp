@@ -1,16 +1,134 @@
+#include <algorithm>
 #include <fstream>
+#include <stdexcept>
+#include <vector>
 #include "sdf_loader.hpp"
+#include "sdf_mmap.hpp"
+#include "sdf_chunker.hpp"
+#include "sdf_parallel.hpp"
+#include "sdf_cache.hpp"
+#include "sdf_escape.hpp"
+#include "sdf_decompress.hpp"
+#include "sdf_pipe.hpp"
 
-#include "sdf_lexer.hpp"
+#include "sdf_flex_lexer.hpp"
+#include "sdf_fast_lexer.hpp"
 #include "sdf_parser.gen.hpp"
 #include "location.hh"
 
+namespace /*anonymous*/ {
+
+//Files smaller than this are not worth parsing in parallel
+constexpr size_t MIN_PARALLEL_FILE_SIZE = 4 << 20;
+
+//Number of chunks to split a file into per thread (for load balancing)
+constexpr size_t CHUNKS_PER_THREAD = 8;
+
+double seconds_since(std::chrono::steady_clock::time_point start);
+std::vector<std::string> make_token_names();
+const std::string& token_name(size_t kind);
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Returns the name of each token, indexed by its symbol kind
+//
+//The kinds are found by constructing each token, which (unlike the
+//parser's internal name table) works across Bison versions.
+std::vector<std::string> make_token_names() {
+    using sdfparse::Parser;
+    sdfparse::location loc;
+
+    std::vector<std::string> names;
+    auto add = [&](const Parser::symbol_type& token, const char* name) {
+        size_t kind = token.type_get();
+        if(kind >= names.size()) {
+            names.resize(kind + 1, "<unknown>");
+        }
+        names[kind] = name;
+    };
+
+    add(Parser::make_LPAR(loc), "(");
+    add(Parser::make_RPAR(loc), ")");
+    add(Parser::make_DELAYFILE(loc), "DELAYFILE");
+    add(Parser::make_SDFVERSION(loc), "SDFVERSION");
+    add(Parser::make_DESIGN(loc), "DESIGN");
+    add(Parser::make_VENDOR(loc), "VENDOR");
+    add(Parser::make_PROGRAM(loc), "PROGRAM");
+    add(Parser::make_VERSION(loc), "VERSION");
+    add(Parser::make_DIVIDER(loc), "DIVIDER");
+    add(Parser::make_TIMESCALE(loc), "TIMESCALE");
+    add(Parser::make_CELL(loc), "CELL");
+    add(Parser::make_CELLTYPE(loc), "CELLTYPE");
+    add(Parser::make_INSTANCE(loc), "INSTANCE");
+    add(Parser::make_DELAY(loc), "DELAY");
+    add(Parser::make_ABSOLUTE(loc), "ABSOLUTE");
+    add(Parser::make_IOPATH(loc), "IOPATH");
+    add(Parser::make_COLON(loc), ":");
+    add(Parser::make_POSEDGE(loc), "posedge");
+    add(Parser::make_NEGEDGE(loc), "negedge");
+    add(Parser::make_SETUP(loc), "SETUP");
+    add(Parser::make_HOLD(loc), "HOLD");
+    add(Parser::make_REMOVAL(loc), "REMOVAL");
+    add(Parser::make_RECOVERY(loc), "RECOVERY");
+    add(Parser::make_TIMINGCHECK(loc), "TIMINGCHECK");
+    add(Parser::make_Float(0., loc), "float");
+    add(Parser::make_String("", loc), "string");
+    add(Parser::make_Qstring("", loc), "quoted-string");
+    add(Parser::make_EOF(loc), "end-of-file");
+    return names;
+}
+
+const std::string& token_name(size_t kind) {
+    static const std::vector<std::string> names = make_token_names();
+    static const std::string unknown = "<unknown>";
+    return (kind < names.size()) ? names[kind] : unknown;
+}
+
+} //namespace
+
 namespace sdfparse {
 
+//Collects the statistics of a load (if enabled) over the lifetime of
+//the outermost scope, since the load methods may call each other
+class Loader::StatsScope {
+    public:
+        explicit StatsScope(Loader& loader)
+            : loader_(loader)
+            , active_(loader.collect_stats_ && loader.stats_depth_++ == 0) {
+            if(active_) {
+                loader_.stats_ = LoaderStats();
+                start_ = Clock::now();
+            }
+        }
+
+        ~StatsScope() {
+            if(!loader_.collect_stats_) return;
+            --loader_.stats_depth_;
+            if(!active_) return;
+
+            LoaderStats& stats = loader_.stats_;
+            stats.total_time = seconds_since(start_);
+            stats.num_symbols = loader_.symbols_->size();
+            stats.arena_blocks = loader_.arena_->num_blocks();
+            stats.arena_bytes_allocated = loader_.arena_->bytes_allocated();
+            stats.arena_bytes_reserved = loader_.arena_->bytes_reserved();
+        }
+
+    private:
+        Loader& loader_;
+        bool active_;
+        Clock::time_point start_;
+};
+
 Loader::Loader()
     : filename_("") //Initialize the filename
-    , lexer_(new Lexer())
-    , parser_(new Parser(*lexer_, *this)) {
+    , lexer_type_(LexerType::FLEX)
+    , lexer_(new FlexSdfLexer())
+    , parser_(new Parser(*lexer_, *this))
+    , symbols_(std::make_shared<SymbolTable>())
+    , arena_(std::make_shared<Arena>()) {
 }
 
 
@@ -20,44 +138,495 @@ Loader::Loader()
 Loader::~Loader()
     {}
 
+void Loader::set_lexer_type(LexerType type) {
+    lexer_type_ = type;
+
+    if(type == LexerType::FAST) {
+        lexer_.reset(new FastSdfLexer());
+    } else {
+        assert(type == LexerType::FLEX);
+        lexer_.reset(new FlexSdfLexer());
+    }
+
+    //The parser refers to the lexer, so must be re-created
+    parser_.reset(new Parser(*lexer_, *this));
+}
+
 bool Loader::load(std::string filename) {
+    StatsScope stats_scope(*this);
+
+    Compression compression = detect_compression(filename);
+    if(compression != Compression::NONE || read_ahead_) {
+        //Read (and decompress) on another thread while parsing
+        std::unique_ptr<ByteSource> source;
+        auto start = Clock::now();
+        try {
+            if(compression == Compression::NONE) {
+                source = open_file_source(filename);
+            } else {
+                source = open_decompressor(filename, compression);
+            }
+        } catch(std::runtime_error& error) {
+            filename_ = filename;
+            auto pos = position(&filename_);
+            ParseError parse_error(error.what(), location(pos, pos));
+            on_error(parse_error);
+            return false;
+        }
+        if(collect_stats_) stats_.open_time += seconds_since(start);
+
+        return load_piped(std::move(source), filename);
+    }
+
+    auto start = Clock::now();
     std::ifstream is(filename);
+    if(collect_stats_) stats_.open_time += seconds_since(start);
+
     return load(is, filename);
 }
 
 bool Loader::load(std::istream& is, std::string filename) {
     assert(is.good());
+    StatsScope stats_scope(*this);
 
     //Update the filename for location references
     filename_ = filename;
 
     //Point the lexer at the new input
-    lexer_->switch_streams(&is);
+    lexer_->set_input(is);
+
+    return parse();
+}
+
+bool Loader::load_mapped(std::string filename) {
+#if SDFPARSE_HAVE_MMAP
+    StatsScope stats_scope(*this);
+    filename_ = filename;
+
+    auto start = Clock::now();
+    MappedFile mapped_file;
+    if(!mapped_file.open(filename_)) {
+        auto pos = position(&filename_);
+        ParseError error("Failed to open file", location(pos, pos));
+        on_error(error);
+        return false;
+    }
+    if(collect_stats_) stats_.open_time += seconds_since(start);
+
+    if(detect_compression(mapped_file.begin(), mapped_file.size()) != Compression::NONE) {
+        mapped_file.close();
+        return load(filename);
+    }
+
+    //Lex directly from the mapping
+    lexer_->set_input(mapped_file.begin(), mapped_file.end());
+
+    bool success = parse();
+
+    //Detach the lexer before the mapping is released
+    lexer_->set_input(nullptr, nullptr);
+
+    return success;
+#else
+    return load(filename);
+#endif
+}
+
+bool Loader::load_parallel(std::string filename, size_t num_threads) {
+#if SDFPARSE_HAVE_MMAP
+    if(num_threads == 0) {
+        num_threads = default_num_threads();
+    }
+
+    StatsScope stats_scope(*this);
+    filename_ = filename;
+
+    auto start = Clock::now();
+    MappedFile mapped_file;
+    if(!mapped_file.open(filename_)) {
+        auto pos = position(&filename_);
+        ParseError error("Failed to open file", location(pos, pos));
+        on_error(error);
+        return false;
+    }
+
+    if(detect_compression(mapped_file.begin(), mapped_file.size()) != Compression::NONE) {
+        //Compressed input can only be parsed serially
+        mapped_file.close();
+        return load(filename);
+    }
+
+    TextChunk header;
+    std::vector<TextChunk> cell_chunks;
+    bool split = num_threads > 1
+                 && mapped_file.size() >= MIN_PARALLEL_FILE_SIZE
+                 && split_sdf_cells(mapped_file.begin(), mapped_file.end(),
+                                    num_threads * CHUNKS_PER_THREAD, num_threads,
+                                    header, cell_chunks);
+    if(collect_stats_) stats_.open_time += seconds_since(start);
+
+    if(!split) {
+        //Parse serially
+        lexer_->set_input(mapped_file.begin(), mapped_file.end());
+        bool success = parse();
+        lexer_->set_input(nullptr, nullptr);
+        return success;
+    }
+
+    //Parse the header (fragment 0) and each chunk of cells concurrently,
+    //each with its own lexer, parser and arena, but sharing a symbol table
+    reset_storage();
+
+    size_t num_fragments = cell_chunks.size() + 1;
+    std::vector<std::unique_ptr<Loader>> fragment_loaders(num_fragments);
+    auto parallel_start = Clock::now();
+    std::vector<char> succeeded(num_fragments, false);
+    parallel_for(num_fragments, num_threads, [&](size_t i) {
+        const TextChunk& chunk = (i == 0) ? header : cell_chunks[i - 1];
+        Fragment fragment = (i == 0) ? Fragment::HEADER : Fragment::CELLS;
+
+        std::unique_ptr<Loader> loader(new Loader());
+        loader->set_lexer_type(lexer_type_);
+        loader->set_cell_storage(cell_storage_);
+        loader->set_collect_stats(collect_stats_);
+        loader->symbols_ = symbols_;
+        loader->lexer_->set_input(chunk.begin, chunk.end);
+
+        //Locations refer to this loader's filename, and start where the chunk does
+        auto pos = position(&filename_, chunk.line, chunk.column);
+        try {
+            succeeded[i] = loader->run_parser(location(pos, pos), fragment);
+        } catch (ParseError& /*error*/) {
+            //Reported by the serial re-parse below
+        }
+        loader->lexer_->set_input(nullptr, nullptr);
+
+        fragment_loaders[i] = std::move(loader);
+    });
+
+    //A fragment's parser cannot tell what the whole-file grammar would
+    //have expected at its ends, so on failure re-parse serially to report
+    //the same error (and location) as a serial parse would
+    for(size_t i = 0; i < num_fragments; ++i) {
+        if(!succeeded[i]) {
+            fragment_loaders.clear();
+            lexer_->set_input(mapped_file.begin(), mapped_file.end());
+            bool success = parse();
+            lexer_->set_input(nullptr, nullptr);
+            return success;
+        }
+    }
+
+    auto merge_start = Clock::now();
+    if(collect_stats_) {
+        stats_.parallel_time += std::chrono::duration<double>(merge_start - parallel_start).count();
+        stats_.num_threads = std::min(num_threads, num_fragments);
+        for(const auto& loader : fragment_loaders) {
+            stats_.add(loader->stats_);
+        }
+    }
+
+    //Report the header and then the cells, in file order
+    header_ = std::move(fragment_loaders[0]->header_);
+    header_reported_ = false;
+
+    size_t num_cells = 0;
+    for(size_t i = 1; i < num_fragments; ++i) {
+        num_cells += fragment_loaders[i]->cells_.size();
+    }
+    cells_.clear();
+    cells_.reserve(num_cells);
+
+    //The fragments' cells are already stored (as cell_storage_ specifies),
+    //taking over the fragments' arenas rather than copying them
+    replaying_cells_ = true;
+    auto start_pos = position(&filename_);
+    location start_loc(start_pos, start_pos);
+    lexer_->set_loc(start_loc); //See current_location()
+    try {
+        report_header();
+        for(size_t i = 1; i < num_fragments; ++i) {
+            arena_->adopt(*fragment_loaders[i]->arena_);
+            for(Cell& cell : fragment_loaders[i]->cells_) {
+                report_cell(std::move(cell));
+            }
+            fragment_loaders[i].reset();
+        }
+    } catch (ParseError& error) {
+        replaying_cells_ = false;
+        on_error(error);
+        return false;
+    }
+    replaying_cells_ = false;
+
+    finish_delayfile();
+    if(collect_stats_) stats_.merge_time += seconds_since(merge_start);
+    return true;
+#else
+    (void) num_threads;
+    return load(filename);
+#endif
+}
+
+bool Loader::load_cached(std::string filename, std::string cache_filename, bool check_hash) {
+    if(cache_filename.empty()) {
+        cache_filename = filename + ".cache";
+    }
+
+    StatsScope stats_scope(*this);
+    auto start = Clock::now();
+
+    SourceStamp stamp;
+    if(!stamp_sdf_file(filename, check_hash, stamp)) {
+        filename_ = filename;
+        auto pos = position(&filename_);
+        ParseError error("Failed to open file", location(pos, pos));
+        on_error(error);
+        return false;
+    }
+
+    reset_storage();
+    std::vector<Cell> cells;
+    //With CellStorage::HEAP the cells are copied out of the cache's arena as they are reported
+    auto cache_arena = (cell_storage_ == CellStorage::ARENA) ? arena_ : std::make_shared<Arena>();
+    bool cache_read = read_sdf_cache(cache_filename, stamp, *symbols_, *cache_arena, header_, cells);
+    if(collect_stats_) stats_.open_time += seconds_since(start);
+
+    if(cache_read) {
+        filename_ = filename;
+        if(collect_stats_) {
+            stats_.num_cells = cells.size();
+            for(const Cell& cell : cells) {
+                stats_.num_iopaths += cell.delay().iopaths().size();
+                stats_.num_timing_checks += cell.timing_check().timing().size();
+            }
+        }
+
+        //Report the cached results as if they had been parsed
+        header_reported_ = false;
+        cells_.clear();
+        cells_.reserve(cells.size());
+        replaying_cells_ = true;
+        auto start_pos = position(&filename_);
+        location start_loc(start_pos, start_pos);
+        lexer_->set_loc(start_loc); //See current_location()
+        try {
+            report_header();
+            for(Cell& cell : cells) {
+                report_cell(std::move(cell));
+            }
+        } catch (ParseError& error) {
+            replaying_cells_ = false;
+            on_error(error);
+            return false;
+        }
+        replaying_cells_ = false;
+
+        finish_delayfile();
+        return true;
+    }
+
+    if(!load_parallel(filename)) {
+        return false;
+    }
+
+    //Only cache complete results (on_cell() may not have collected the cells)
+    if(delayfile_.cells().size() == num_cells_reported_) {
+        write_sdf_cache(cache_filename, delayfile_, stamp);
+    }
+    return true;
+}
+
+bool Loader::load_piped(std::unique_ptr<ByteSource> source, std::string filename) {
+    filename_ = filename;
+
+    PipeStreambuf pipe(std::move(source));
+    std::istream is(&pipe);
+    lexer_->set_input(is);
+
+    bool success = parse(&pipe);
+
+    //Detach the lexer before the pipe is destroyed
+    lexer_->set_input(nullptr, nullptr);
+
+    return success;
+}
+
+bool Loader::parse(const PipeStreambuf* input_pipe) {
+    StatsScope stats_scope(*this);
 
     //Initialize locations with filename
     auto pos = position(&filename_);
     auto loc = location(pos, pos);
-    lexer_->set_loc(loc);
 
-    int retval;
+    //Names and lists are stored afresh, owned by the resulting DelayFile
+    reset_storage();
+
     try {
         //Do the parsing
-        retval = parser_->parse();
+        bool success = run_parser(loc, Fragment::WHOLE_FILE);
+
+        if(input_pipe && input_pipe->failed()) {
+            //Input which ended early may still have parsed
+            throw ParseError(input_pipe->error(), lexer_->get_loc());
+        }
+        if(!success) {
+            return false;
+        }
+        finish_delayfile();
+        return true;
 
     } catch (ParseError& error) {
+        if(input_pipe && input_pipe->failed()) {
+            //Failing to read the input is the cause of any parse error
+            ParseError input_error(input_pipe->error(), error.loc());
+            on_error(input_error);
+            return false;
+        }
+
         //Users can re-define on_error if they want
         //to do something else (like re-throw)
         on_error(error);
         return false;
     }
+}
+
+bool Loader::run_parser(const location& start_loc, Fragment fragment) {
+    header_ = Header();
+    header_reported_ = false;
+    cells_.clear();
+    iopaths_.clear();
+    timing_checks_.clear();
+
+    location loc = start_loc;
+    lexer_->set_loc(loc);
+    lexer_->set_fragment(fragment);
+    lexer_->set_count_tokens(collect_stats_);
+
+    auto start = Clock::now();
+    double build_time = stats_.build_time;
+
+    int retval = parser_->parse();
+
+    if(collect_stats_) {
+        const std::vector<size_t>& token_counts = lexer_->token_counts();
+        for(size_t kind = 0; kind < token_counts.size(); ++kind) {
+            if(token_counts[kind] > 0) {
+                stats_.tokens_by_kind[token_name(kind)] += token_counts[kind];
+                stats_.num_tokens += token_counts[kind];
+            }
+        }
+        stats_.bytes_read += lexer_->bytes_read();
+        //The lex time is an estimate, so keep it within the measured time
+        double parse_time = seconds_since(start) - (stats_.build_time - build_time);
+        double lex_time = std::min(lexer_->lex_time(), parse_time);
+        stats_.lex_time += lex_time;
+        stats_.parse_time += parse_time - lex_time;
+    }
 
     //Bision returns 0 if successful
     return (retval == 0);
 }
 
+location Loader::current_location() const {
+    return lexer_->get_loc();
+}
+
 void Loader::on_error(ParseError& error) {
     //Default implementation, just print out the error
     std::cout << "SDF Error " << error.loc() << ": " << error.what() << "\n";
 }
 
+void Loader::on_header(const Header& /*header*/) {
+    //Default implementation, nothing to do since the header is
+    //kept in header_ until the DelayFile is built
+}
+
+void Loader::on_cell(Cell&& cell) {
+    //Default implementation, collect the cell for the DelayFile
+    bool stored = replaying_cells_
+                  && (cell_storage_ == CellStorage::ARENA
+                      || (cell.delay().owns_iopaths() && cell.timing_check().owns_timing()));
+    if(stored) {
+        //Already in arena_ (adopted from a parallel load or read from a cache), or owned
+        cells_.push_back(std::move(cell));
+    } else {
+        //Copy the cell's lists out of the parser's scratch storage (or the cache's arena)
+        cells_.push_back(copy_cell(cell, intern_instance(cell), cell_storage_, *arena_));
+    }
+}
+
+void Loader::report_header() {
+    if(!header_reported_) {
+        header_reported_ = true;
+        on_header(header_);
+    }
+}
+
+void Loader::add_cell(Cell&& cell) {
+    Clock::time_point start;
+    if(collect_stats_) {
+        ++stats_.num_cells;
+        stats_.num_iopaths += iopaths_.size();
+        stats_.num_timing_checks += timing_checks_.size();
+        stats_.max_cell_iopaths = std::max(stats_.max_cell_iopaths, iopaths_.size());
+        stats_.max_cell_timing_checks = std::max(stats_.max_cell_timing_checks, timing_checks_.size());
+        start = Clock::now();
+    }
+
+    //The header is complete once the first cell has been parsed
+    report_header();
+    report_cell(std::move(cell));
+
+    if(collect_stats_) stats_.build_time += seconds_since(start);
+
+    //The cell's lists are no longer referenced
+    iopaths_.clear();
+    timing_checks_.clear();
+}
+
+Symbol Loader::intern_instance(const Cell& cell) {
+    Symbol instance = cell.instance_symbol();
+    if(&instance.str() == &instance_) {
+        return symbols_->intern(instance_);
+    }
+    return instance; //Already interned (e.g. replayed from a parallel load or cache)
+}
+
+Symbol Loader::scratch_instance(std::string&& str) {
+    instance_ = std::move(str);
+    return Symbol(&instance_);
+}
+
+std::string Loader::unescape(std::string&& str) {
+    size_t len = str.size();
+    unescape_sdf_identifier_in_place(str);
+
+    if(collect_stats_) {
+        ++stats_.num_identifiers;
+        if(str.size() != len) {
+            ++stats_.num_escaped_identifiers;
+        }
+    }
+    return std::move(str);
+}
+
+void Loader::report_cell(Cell&& cell) {
+    ++num_cells_reported_;
+    on_cell(std::move(cell));
+}
+
+void Loader::reset_storage() {
+    symbols_ = shared_symbols_ ? shared_symbols_ : std::make_shared<SymbolTable>();
+    arena_ = std::make_shared<Arena>();
+    num_cells_reported_ = 0;
+}
+
+void Loader::finish_delayfile() {
+    if(collect_stats_) stats_.cells_capacity = cells_.capacity();
+    delayfile_ = DelayFile(std::move(header_), std::move(cells_), symbols_, arena_);
+    header_ = Header();
+    cells_.clear();
+}
+
 } //sdfparse
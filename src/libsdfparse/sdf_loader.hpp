@@ -2,8 +2,10 @@
 
 #include <iosfwd>
 #include <memory>
+#include <chrono>
 
 #include "sdf_data.hpp"
+#include "sdf_loader_stats.hpp"
 
 namespace sdfparse {
 
@@ -11,6 +13,16 @@ namespace sdfparse {
 class Lexer;
 class Parser;
 class ParseError;
+class location;
+class ByteSource;
+class PipeStreambuf;
+enum class Fragment;
+
+//The available lexer implementations
+enum class LexerType {
+    FLEX, //Table-driven lexer generated by flex (FlexSdfLexer)
+    FAST  //Hand-written SIMD-accelerated lexer (FastSdfLexer)
+};
 
 //Class for loading an SDF file.
 //
@@ -18,30 +30,189 @@ class ParseError;
 //if successful - after which the loaded data can be accessed via 
 //get_delayfile().
 //
+//The lexer used can be selected with set_lexer_type().
+//
+//The virtual methods on_header() and on_cell() are called as the header and
+//each cell are parsed. By default they collect the results into the DelayFile.
+//They can be overridden to process an SDF file in a streaming fashion,
+//without holding all the cells in memory (in which case get_delayfile()
+//will contain only the header). Note that the IOPATH and timing check lists
+//of the cell passed to on_cell() are only valid during the call, as is its
+//instance name unless interned with intern_instance(): instance names are
+//unique per cell, so interning them would grow the symbol table with the
+//file even when streaming.
+//
 //The virtual method on_error() can be overriding to control
 //error handling. The default simply prints out an error message,
-//but it could also be defined to (re-)throw an exception.
+//but it could also be defined to (re-)throw an exception. Errors
+//thrown as ParseError by on_header() or on_cell() are also passed to
+//on_error(), and fail the load.
+//
+//Statistics about each load (see LoaderStats) are collected if enabled
+//with set_collect_stats(). They are off by default, in which case no
+//timing or counting is done; when enabled every token is counted and a
+//sample of them timed.
+//
+//A Loader must only be used by one thread at a time, but separate Loaders
+//may load files concurrently (see BatchLoader to load many files at once).
 class Loader {
 
     public:
         Loader();
         ~Loader();
 
+        //Loads the file. Compressed (gzip or zstd) files are detected and
+        //decompressed on a separate thread, overlapping with parsing.
+        //Uncompressed files are also read on a separate thread if read-ahead
+        //is enabled (see set_read_ahead()).
         bool load(std::string filename);
         bool load(std::istream& is, std::string filename="<inputstream>");
 
+        //Loads the file by memory-mapping it and lexing directly from the
+        //mapping, avoiding iostream buffering and any extra copy of the input.
+        //Falls back to load(filename) where memory mapping is unavailable,
+        //or if the file is compressed.
+        bool load_mapped(std::string filename);
+
+        //Loads the file using multiple threads (0 uses one per hardware thread).
+        //
+        //The memory-mapped file is split at top-level CELL boundaries, and
+        //the header and each chunk of cells are parsed concurrently before
+        //being merged (in file order). If any chunk fails the whole file is
+        //re-parsed serially, so errors (and any cells reported before them)
+        //are exactly those of load_mapped(). Small or irregular files are
+        //parsed serially, as with load_mapped().
+        bool load_parallel(std::string filename, size_t num_threads=0);
+
+        //Loads the file from a binary cache (see sdf_cache.hpp) if there is a
+        //valid one, otherwise parses it (with load_parallel()) and writes the cache.
+        //
+        //The cache is stale if the file's size or modification time have changed
+        //since the cache was written; if check_hash is true the file's contents
+        //are hashed and compared instead of the modification time (so caches
+        //remain valid when copied along with the file to another machine).
+        //An empty cache_filename uses filename + ".cache". Failing to write
+        //the cache is not an error.
+        bool load_cached(std::string filename, std::string cache_filename="", bool check_hash=false);
+
         const DelayFile& get_delayfile() { return delayfile_; };
 
+        void set_lexer_type(LexerType type);
+        LexerType lexer_type() const { return lexer_type_; }
+
+        //Enables or disables read-ahead for load(filename) (off by default).
+        //
+        //The file is read on a dedicated I/O thread into large aligned
+        //buffers, with the OS advised to read ahead of it, so the next part
+        //of the file is ready as soon as the lexer needs it (rather than
+        //the lexer stalling on each read). This helps most on cold caches
+        //and slow (e.g. network) filesystems.
+        void set_read_ahead(bool read_ahead) { read_ahead_ = read_ahead; }
+        bool read_ahead() const { return read_ahead_; }
+
+        //Sets how the lists of collected cells are stored (see CellStorage).
+        //CellStorage::HEAP (the default) makes each cell an independent value;
+        //CellStorage::ARENA loads and frees large files faster.
+        void set_cell_storage(CellStorage storage) { cell_storage_ = storage; }
+        CellStorage cell_storage() const { return cell_storage_; }
+
+        //Enables or disables collecting statistics during subsequent loads
+        void set_collect_stats(bool collect) { collect_stats_ = collect; }
+        bool collect_stats() const { return collect_stats_; }
+
+        //Statistics for the most recent load (if collected)
+        const LoaderStats& stats() const { return stats_; }
+
     protected:
         virtual void on_error(ParseError& error);
 
+        //Called once the header has been parsed (before any cells)
+        virtual void on_header(const Header& header);
+
+        //Called as each cell is parsed (in file order)
+        //
+        //The cell's lists (and instance) refer to temporary storage, which is
+        //re-used once on_cell() returns; the default implementation copies
+        //them into the resulting DelayFile (see set_cell_storage()).
+        virtual void on_cell(Cell&& cell);
+
+        //The table names are being interned in, which will be owned by the
+        //resulting DelayFile
+        std::shared_ptr<const SymbolTable> symbols() const { return symbols_; }
+
+        //Returns the instance of a cell passed to on_cell() as a Symbol of
+        //symbols(). The cell's own instance_symbol() may refer to scratch
+        //storage which is re-used once on_cell() returns.
+        Symbol intern_instance(const Cell& cell);
+
+        //The location the parser has reached (e.g. for errors found by
+        //on_cell()). This is only the start of the file when the cells
+        //were parsed in parallel or read from a cache, since they are
+        //reported once all have been loaded.
+        location current_location() const;
+
+    private:
+        class StatsScope;
+        typedef std::chrono::steady_clock Clock;
+
+        //Parses the lexer's input. If the input is read through a pipe, any
+        //error reading it is reported in preference to the resulting parse error.
+        bool parse(const PipeStreambuf* input_pipe=nullptr);
+
+        //Loads from source, which is read on a separate thread
+        bool load_piped(std::unique_ptr<ByteSource> source, std::string filename);
+
+        //Called by the parser
+        void report_header();
+        void add_cell(Cell&& cell);
+
+        Symbol intern(std::string&& str) { return symbols_->intern(std::move(str)); }
+        Symbol scratch_instance(std::string&& str); //Stored in instance_ (see intern_instance())
+        std::string unescape(std::string&& str);
+
+        //Passes a cell to on_cell()
+        void report_cell(Cell&& cell);
+
+        //Creates new (empty) storage for the DelayFile being loaded
+        void reset_storage();
+
+        //Builds delayfile_ from the collected header and cells
+        void finish_delayfile();
+
+        //Runs the parser over the lexer's current input, starting at
+        //start_loc. Errors are thrown as ParseError.
+        bool run_parser(const location& start_loc, Fragment fragment);
+
     private:
         friend Parser;
+        friend class LazyDelayFile; //Parses fragments of a file with run_parser()
+        friend class BatchLoader; //Shares a symbol table between loaders, and takes over their results
         std::string filename_;
+        LexerType lexer_type_;
+        bool read_ahead_ = false;
+        CellStorage cell_storage_ = CellStorage::HEAP;
         std::unique_ptr<Lexer> lexer_;
         std::unique_ptr<Parser> parser_;
 
         DelayFile delayfile_;
+
+        std::shared_ptr<SymbolTable> symbols_; //Names interned while parsing
+        std::shared_ptr<SymbolTable> shared_symbols_; //If set, used as symbols_ by every load (rather than a new table)
+        std::shared_ptr<Arena> arena_; //Storage for the lists of collected cells (with CellStorage::ARENA)
+        Header header_; //Header being parsed
+        bool header_reported_ = false; //Whether on_header() has been called
+        std::vector<Cell> cells_; //Cells collected by on_cell()
+        size_t num_cells_reported_ = 0; //Number of cells passed to on_cell()
+        bool replaying_cells_ = false; //Whether on_cell() is passed cells which are already stored (see on_cell())
+
+        //Scratch instance name and lists for the cell being parsed
+        std::string instance_;
+        std::vector<Iopath> iopaths_;
+        std::vector<Timing> timing_checks_;
+
+        bool collect_stats_ = false; //Whether stats_ is collected
+        LoaderStats stats_; //Statistics of the current (or most recent) load
+        int stats_depth_ = 0; //Number of active StatsScopes (load methods may call each other)
 };
 
 } //sdfparse
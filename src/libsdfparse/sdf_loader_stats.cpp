@@ -0,0 +1,100 @@
+#include "sdf_loader_stats.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace /*anonymous*/ {
+
+void print_time(std::ostream& os, const char* name, double time, double total_time);
+
+void print_time(std::ostream& os, const char* name, double time, double total_time) {
+    os << "  " << std::left << std::setw(8) << name << std::right
+       << std::fixed << std::setprecision(4) << std::setw(10) << time << " s";
+    if(total_time > 0.) {
+        os << std::setprecision(1) << std::setw(7) << 100. * time / total_time << " %";
+    }
+    os << "\n";
+}
+
+} //namespace
+
+namespace sdfparse {
+
+void LoaderStats::add(const LoaderStats& other) {
+    bytes_read += other.bytes_read;
+    num_tokens += other.num_tokens;
+    for(const auto& kv : other.tokens_by_kind) {
+        tokens_by_kind[kv.first] += kv.second;
+    }
+
+    num_cells += other.num_cells;
+    num_iopaths += other.num_iopaths;
+    num_timing_checks += other.num_timing_checks;
+    num_identifiers += other.num_identifiers;
+    num_escaped_identifiers += other.num_escaped_identifiers;
+
+    open_time += other.open_time;
+    lex_time += other.lex_time;
+    parse_time += other.parse_time;
+    build_time += other.build_time;
+    parallel_time += other.parallel_time;
+    merge_time += other.merge_time;
+
+    max_cell_iopaths = std::max(max_cell_iopaths, other.max_cell_iopaths);
+    max_cell_timing_checks = std::max(max_cell_timing_checks, other.max_cell_timing_checks);
+}
+
+void LoaderStats::print(std::ostream& os) const {
+    auto flags = os.flags();
+    auto precision = os.precision();
+
+    os << "Input:\n";
+    os << "  bytes read: " << bytes_read << "\n";
+    os << "  tokens: " << num_tokens << "\n";
+    for(const auto& kv : tokens_by_kind) {
+        os << "    " << std::left << std::setw(16) << kv.first << std::right << " " << kv.second << "\n";
+    }
+
+    os << "Results:\n";
+    os << "  cells: " << num_cells << "\n";
+    os << "  iopaths: " << num_iopaths << "\n";
+    os << "  timing checks: " << num_timing_checks << "\n";
+    os << "  identifiers: " << num_identifiers << " (" << num_escaped_identifiers << " escaped)\n";
+
+    os << "Time:\n";
+    print_time(os, "open", open_time, total_time);
+    if(num_threads > 1) {
+        //Times summed over threads are not comparable to the wall-clock total
+        print_time(os, "parallel", parallel_time, total_time);
+        print_time(os, "merge", merge_time, total_time);
+        print_time(os, "total", total_time, 0.);
+
+        double thread_time = lex_time + parse_time + build_time;
+        os << "Thread time (summed over " << num_threads << " threads):\n";
+        print_time(os, "lex", lex_time, thread_time);
+        print_time(os, "parse", parse_time, thread_time);
+        print_time(os, "build", build_time, thread_time);
+        print_time(os, "total", thread_time, 0.);
+    } else {
+        print_time(os, "lex", lex_time, total_time);
+        print_time(os, "parse", parse_time, total_time);
+        print_time(os, "build", build_time, total_time);
+        print_time(os, "total", total_time, 0.);
+    }
+    if(total_time > 0.) {
+        os << "  throughput: " << std::setprecision(1) << bytes_read / total_time / (1024. * 1024.) << " MiB/s\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+
+    os << "Memory:\n";
+    os << "  symbols: " << num_symbols << "\n";
+    os << "  arena: " << arena_bytes_allocated << " bytes allocated, "
+       << arena_bytes_reserved << " bytes reserved in " << arena_blocks << " blocks\n";
+    os << "  peak iopaths per cell: " << max_cell_iopaths << "\n";
+    os << "  peak timing checks per cell: " << max_cell_timing_checks << "\n";
+    os << "  cell list capacity: " << cells_capacity << "\n";
+}
+
+} //sdfparse
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace sdfparse {
+
+//Statistics describing a load, collected by a Loader when enabled
+//with Loader::set_collect_stats()
+//
+//For parallel loads the lex, parse and build times are summed over all
+//threads (so may exceed total_time), while the other times are elapsed
+//wall-clock time. The lex time is estimated from a sample of the tokens.
+//
+//Only memory held in the resulting DelayFile's arena and symbol table is
+//accounted for. Heap allocations are not counted, as that would require
+//replacing the global operator new.
+struct LoaderStats {
+    //Input
+    size_t bytes_read = 0; //Bytes of SDF text read by the lexer(s)
+    size_t num_tokens = 0; //Total number of tokens lexed
+    std::map<std::string,size_t> tokens_by_kind; //Number of tokens lexed, by token name
+
+    //Results
+    size_t num_cells = 0;
+    size_t num_iopaths = 0;
+    size_t num_timing_checks = 0;
+    size_t num_identifiers = 0; //Identifiers (quoted or not) unescaped
+    size_t num_escaped_identifiers = 0; //Identifiers which contained escapes
+
+    //Phase times (in seconds)
+    double open_time = 0.; //Opening/mapping the input, or reading the cache
+    double lex_time = 0.; //Lexing
+    double parse_time = 0.; //Parsing (excluding lexing and building)
+    double build_time = 0.; //Building cells (i.e. in on_cell())
+    double parallel_time = 0.; //Parsing concurrently, in parallel loads (wall-clock)
+    double merge_time = 0.; //Merging the results of parallel loads
+    double total_time = 0.;
+    size_t num_threads = 1; //Threads the lex, parse and build times are summed over
+
+    //Memory
+    size_t num_symbols = 0; //Distinct names interned
+    size_t arena_blocks = 0; //Blocks allocated by the arena
+    size_t arena_bytes_allocated = 0; //Bytes handed out by the arena
+    size_t arena_bytes_reserved = 0; //Bytes held by the arena's blocks
+    size_t max_cell_iopaths = 0; //Peak size of the per-cell IOPATH scratch list
+    size_t max_cell_timing_checks = 0; //Peak size of the per-cell timing check scratch list
+    size_t cells_capacity = 0; //Capacity of the collected cell list
+
+    //Accumulates the input, result and phase time statistics of other
+    //(e.g. from a loader which parsed part of the same file)
+    void add(const LoaderStats& other);
+
+    void print(std::ostream& os) const;
+};
+
+} //sdfparse
@@ -0,0 +1,78 @@
+#include "sdf_mmap.hpp"
+
+#if SDFPARSE_HAVE_MMAP
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace sdfparse {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename, AccessPattern pattern) {
+    close();
+
+#if SDFPARSE_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if(size > 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+
+        data_ = static_cast<const char*>(addr);
+    }
+
+    //The mapping remains valid after the descriptor is closed
+    ::close(fd);
+
+    size_ = size;
+    is_open_ = true;
+    advise(pattern);
+    return true;
+#else
+    (void) filename;
+    (void) pattern;
+    return false;
+#endif
+}
+
+void MappedFile::advise(AccessPattern pattern) {
+#if SDFPARSE_HAVE_MMAP
+    if(data_) {
+        int advice = (pattern == AccessPattern::RANDOM) ? MADV_RANDOM : MADV_SEQUENTIAL;
+        ::madvise(const_cast<char*>(data_), size_, advice);
+    }
+#else
+    (void) pattern;
+#endif
+}
+
+void MappedFile::close() {
+#if SDFPARSE_HAVE_MMAP
+    if(data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+}
+
+} //sdfparse
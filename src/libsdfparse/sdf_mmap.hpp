@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+//Memory mapping is only available on POSIX-like systems
+#if defined(__unix__) || defined(__APPLE__)
+# define SDFPARSE_HAVE_MMAP 1
+#else
+# define SDFPARSE_HAVE_MMAP 0
+#endif
+
+namespace sdfparse {
+
+//How the contents of a MappedFile will be accessed (a hint to the kernel)
+enum class AccessPattern {
+    SEQUENTIAL, //Front-to-back (e.g. when lexing), so read ahead aggressively
+    RANDOM      //In no particular order (e.g. a LazyDelayFile's cells), so do not read ahead
+};
+
+//A read-only memory mapping of a file.
+//
+//The file contents are accessible as the range [begin(), end()) until
+//the MappedFile is closed or destroyed.
+class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        //Maps the specified file, returning true if successful
+        bool open(const std::string& filename, AccessPattern pattern=AccessPattern::SEQUENTIAL);
+        void close();
+
+        //Changes the expected access pattern of the open file
+        void advise(AccessPattern pattern);
+
+        bool is_open() const { return is_open_; }
+        const char* begin() const { return data_; }
+        const char* end() const { return data_ + size_; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool is_open_ = false;
+};
+
+} //sdfparse
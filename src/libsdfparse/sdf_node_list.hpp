@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <type_traits>
+
+#include "sdf_array_view.hpp"
+
+namespace sdfparse {
+
+//A list of nodes in the data model (e.g. a Delay's IOPATHs)
+//
+//The list either owns its elements, in its own heap allocation (so copies
+//of it are independent), or refers to elements stored elsewhere (e.g. in a
+//DelayFile's Arena), which must then outlive it and all its copies. See
+//CellStorage.
+//
+//Owned elements may be modified through mutable_view(), as may referenced
+//ones if the list was created by writable_view() (whose copies share them).
+template<typename T>
+class NodeList {
+    public:
+        static_assert(std::is_trivially_copyable<T>::value, "List elements must be trivially copyable");
+
+        NodeList() = default;
+
+        //Refers to elements (without copying them)
+        NodeList(ArrayView<T> elements)
+            : data_(elements.data())
+            , size_(elements.size())
+            {}
+
+        //Owns a copy of elements
+        explicit NodeList(const std::vector<T>& elements)
+            : NodeList(copy_of(ArrayView<T>(elements)))
+            {}
+
+        //Returns a list owning a copy of elements
+        static NodeList copy_of(ArrayView<T> elements) {
+            NodeList list;
+            if(!elements.empty()) {
+                T* data = new T[elements.size()];
+                std::memcpy(static_cast<void*>(data), elements.data(), elements.size() * sizeof(T));
+                list.data_ = data;
+                list.writable_data_ = data;
+                list.size_ = elements.size();
+                list.owned_ = true;
+            }
+            return list;
+        }
+
+        //Returns a list referring to elements (without copying them) which
+        //may be modified through it
+        static NodeList writable_view(MutableArrayView<T> elements) {
+            NodeList list(elements);
+            list.writable_data_ = elements.data();
+            return list;
+        }
+
+        NodeList(const NodeList& other)
+            : NodeList(other.owned_ ? copy_of(other.view()) : writable_view_of(other))
+            {}
+        NodeList(NodeList&& other) noexcept
+            : data_(other.data_)
+            , writable_data_(other.writable_data_)
+            , size_(other.size_)
+            , owned_(other.owned_) {
+            other.data_ = nullptr;
+            other.writable_data_ = nullptr;
+            other.size_ = 0;
+            other.owned_ = false;
+        }
+        NodeList& operator=(NodeList other) noexcept {
+            std::swap(data_, other.data_);
+            std::swap(writable_data_, other.writable_data_);
+            std::swap(size_, other.size_);
+            std::swap(owned_, other.owned_);
+            return *this;
+        }
+        ~NodeList() {
+            if(owned_) {
+                delete[] data_;
+            }
+        }
+
+        ArrayView<T> view() const { return ArrayView<T>(data_, size_); }
+        size_t size() const { return size_; }
+        bool owns_elements() const { return owned_; }
+
+        //Whether the elements may be modified through mutable_view()
+        bool writable() const { return writable_data_ != nullptr || size_ == 0; }
+
+        MutableArrayView<T> mutable_view() {
+            assert(writable());
+            return MutableArrayView<T>(writable_data_, size_);
+        }
+
+    private:
+        //A (non-owning) copy of other, which is writable if other is
+        static NodeList writable_view_of(const NodeList& other) {
+            NodeList list(other.view());
+            list.writable_data_ = other.writable_data_;
+            return list;
+        }
+
+    private:
+        const T* data_ = nullptr;
+        T* writable_data_ = nullptr; //data_, if the elements may be modified
+        size_t size_ = 0;
+        bool owned_ = false; //Whether data_ was allocated by copy_of()
+};
+
+} //sdfparse
@@ -0,0 +1,118 @@
+#include <cfloat>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "sdf_number.hpp"
+
+namespace /*anonymous*/ {
+
+//Powers of ten which are exactly representable as doubles
+const double EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+constexpr int MAX_EXACT_POWER_OF_TEN = 22;
+
+//Largest integer for which all smaller integers are exactly representable as doubles
+constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+
+//Maximum number of decimal digits which always fit in a uint64_t
+constexpr int MAX_UINT64_DIGITS = 19;
+
+bool is_digit(char c);
+bool parse_number_slow(const char* begin, const char* end, double& value);
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+//Converts the text with a stream, which is always correct but comparatively slow
+bool parse_number_slow(const char* begin, const char* end, double& value) {
+    std::stringstream ss;
+    ss << std::string(begin, end);
+    ss >> value;
+
+    return !ss.fail() && ss.eof();
+}
+
+} //namespace
+
+namespace sdfparse {
+
+bool parse_sdf_number(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+
+    bool negative = false;
+    if(p != end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    //Accumulate the significant digits into an integer mantissa
+    //(ignoring leading zeros), tracking the decimal exponent
+    uint64_t mantissa = 0;
+    int num_mantissa_digits = 0;
+    int exponent = 0;
+    bool seen_digit = false;
+    bool seen_point = false;
+    int trailing_zeros = 0; //Fractional zeros not yet folded into the mantissa
+    for(; p != end; ++p) {
+        char c = *p;
+        if(is_digit(c)) {
+            seen_digit = true;
+            if(seen_point && c == '0') {
+                //Defer fractional zeros, they only matter if followed by a non-zero digit
+                ++trailing_zeros;
+                continue;
+            }
+            for(; trailing_zeros > 0; --trailing_zeros) {
+                if(num_mantissa_digits > 0) {
+                    if(++num_mantissa_digits > MAX_UINT64_DIGITS) {
+                        return parse_number_slow(begin, end, value);
+                    }
+                    mantissa *= 10;
+                }
+                --exponent;
+            }
+            if(mantissa != 0 || c != '0') {
+                if(++num_mantissa_digits > MAX_UINT64_DIGITS) {
+                    return parse_number_slow(begin, end, value);
+                }
+            }
+            mantissa = 10 * mantissa + (c - '0');
+            if(seen_point) {
+                --exponent;
+            }
+        } else if(c == '.' && !seen_point) {
+            seen_point = true;
+        } else {
+            //Unexpected character
+            return parse_number_slow(begin, end, value);
+        }
+    }
+
+    if(!seen_digit) {
+        return parse_number_slow(begin, end, value);
+    }
+
+    double result;
+    if(exponent == 0) {
+        //Integer: the conversion from uint64_t is correctly rounded
+        result = static_cast<double>(mantissa);
+    } else if(mantissa <= MAX_EXACT_MANTISSA
+              && -exponent <= MAX_EXACT_POWER_OF_TEN
+              && FLT_EVAL_METHOD == 0) {
+        //Both the mantissa and power of ten are exact, so the (IEEE correctly
+        //rounded) division gives the correctly rounded result. This requires
+        //that the division is not performed at extended precision.
+        result = static_cast<double>(mantissa) / EXACT_POWERS_OF_TEN[-exponent];
+    } else {
+        return parse_number_slow(begin, end, value);
+    }
+
+    value = negative ? -result : result;
+    return true;
+}
+
+} //sdfparse
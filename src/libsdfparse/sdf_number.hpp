@@ -0,0 +1,17 @@
+#pragma once
+
+namespace sdfparse {
+
+//Converts the SDF number in [begin, end) to a double.
+//
+//The text is expected to match the lexer's number pattern (an optional
+//sign, followed by digits with at most one decimal point). Integers and
+//short decimals are converted directly without allocating; anything else
+//falls back to a stream conversion. In all cases the
+//result is the correctly rounded value, identical to streaming the text
+//into a double.
+//
+//Returns false if the text could not be converted (e.g. it overflows).
+bool parse_sdf_number(const char* begin, const char* end, double& value);
+
+} //sdfparse
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdfparse {
+
+//Returns the number of threads to use by default (one per hardware thread)
+inline size_t default_num_threads() {
+    size_t num_threads = std::thread::hardware_concurrency();
+    return (num_threads > 0) ? num_threads : 1;
+}
+
+//Calls func(i) for each i in [0, num_items) using up to num_threads threads
+//(0 selects default_num_threads()).
+//
+//Items are handed out dynamically (in increasing order) so threads which
+//finish early pick up the remaining work. If func throws, the first
+//exception is re-thrown once all threads have finished.
+template<typename Func>
+void parallel_for(size_t num_items, size_t num_threads, const Func& func) {
+    if(num_threads == 0) {
+        num_threads = default_num_threads();
+    }
+    if(num_threads > num_items) {
+        num_threads = num_items;
+    }
+
+    if(num_threads <= 1) {
+        //Avoid thread start-up cost
+        for(size_t i = 0; i < num_items; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_item(0);
+    std::exception_ptr first_exception;
+    std::mutex exception_mutex;
+
+    auto worker = [&]() {
+        while(true) {
+            size_t i = next_item.fetch_add(1);
+            if(i >= num_items) break;
+
+            try {
+                func(i);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if(!first_exception) {
+                    first_exception = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t ithread = 1; ithread < num_threads; ++ithread) {
+        threads.emplace_back(worker);
+    }
+    worker(); //The calling thread also does work
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    if(first_exception) {
+        std::rethrow_exception(first_exception);
+    }
+}
+
+} //sdfparse
@@ -81,7 +81,19 @@
     //Since we have re-defined the equivalent function in the lexer
     //we need to tell Bison how to get the next token.
     static sdfparse::Parser::symbol_type yylex(sdfparse::Lexer& lexer) {
-        return lexer.next_token();
+        //When parsing a fragment, a start token precedes the actual input
+        switch(lexer.take_fragment()) {
+            case sdfparse::Fragment::HEADER:
+                return sdfparse::Parser::make_HEADER_FRAGMENT(lexer.get_loc());
+            case sdfparse::Fragment::CELLS:
+                return sdfparse::Parser::make_CELL_FRAGMENT(lexer.get_loc());
+            case sdfparse::Fragment::WHOLE_FILE:
+            default:
+                if(lexer.count_tokens()) {
+                    return lexer.next_counted_token();
+                }
+                return lexer.next_token();
+        }
     }
 
     #include <iostream> //For cout in error reporting
@@ -116,19 +128,22 @@
 %token <std::string> Qstring "quoted-string"
 %token EOF 0 "end-of-file"
 
+/*
+ * Start tokens injected ahead of the input (never produced by the lexers),
+ * used to parse a fragment of a file (see Loader::load_parallel())
+ */
+%token HEADER_FRAGMENT "header-fragment"
+%token CELL_FRAGMENT "cell-fragment"
+
 %type <std::string> Id "identifier"
 %type <std::string> Qid "quoted-identifier"
 %type <RealTriple> real_triple
 %type <PortSpec> port_spec
-%type <Iopath> iopath
-%type <std::vector<Iopath>> iopath_list
-%type <std::vector<Iopath>> absolute
 %type <Delay> delay
-%type <std::string> instance
-%type <std::string> celltype
+%type <Symbol> instance
+%type <Symbol> celltype
 %type <PortCondition> port_condition
 %type <TimingCheck> timing_check
-%type <std::vector<Timing>> timing_check_list
 %type <Timing> t_check
 %type <Timing> setup_check
 %type <Timing> hold_check
@@ -142,28 +157,35 @@
 %type <std::string> vendor
 %type <std::string> design
 %type <std::string> sdf_version
-%type <Header> sdf_header
-%type <std::vector<Cell>> cell_list
-%type <DelayFile> sdf_file
 
 %start sdf_file
 
 %%
-sdf_file : LPAR DELAYFILE sdf_header RPAR { driver.delayfile_ = DelayFile($3); }
-         | LPAR DELAYFILE sdf_header cell_list RPAR { driver.delayfile_ = DelayFile($3, $4); }
+sdf_file : LPAR DELAYFILE sdf_header RPAR { driver.report_header(); }
+         | LPAR DELAYFILE sdf_header cell_list RPAR
+         | HEADER_FRAGMENT LPAR DELAYFILE sdf_header
+         | CELL_FRAGMENT cell_list
          ;
 
-sdf_header : sdf_version                    { $$ = Header($1); }
-           | sdf_header design              { $1.set_design($2); $$ = $1; }
-           | sdf_header vendor              { $1.set_vendor($2); $$ = $1; }
-           | sdf_header program             { $1.set_program($2); $$ = $1; }
-           | sdf_header version             { $1.set_version($2); $$ = $1; }
-           | sdf_header hierarchy_divider   { $1.set_divider($2); $$ = $1; }
-           | sdf_header timescale           { $1.set_timescale($2); $$ = $1; }
+/*
+ * The header is built up in the driver (rather than as a semantic value)
+ * so it can be reported as soon as the first cell is parsed.
+ */
+sdf_header : sdf_version                    { driver.header_ = Header($1); }
+           | sdf_header design              { driver.header_.set_design($2); }
+           | sdf_header vendor              { driver.header_.set_vendor($2); }
+           | sdf_header program             { driver.header_.set_program($2); }
+           | sdf_header version             { driver.header_.set_version($2); }
+           | sdf_header hierarchy_divider   { driver.header_.set_divider($2); }
+           | sdf_header timescale           { driver.header_.set_timescale($2); }
            ;
 
-cell_list : cell { $$ = std::vector<Cell>(); $$.push_back($1); }
-          | cell_list cell  { $1.push_back($2); $$ = $1; }
+/*
+ * Cells are handed to the driver as soon as they are parsed (rather than
+ * collected into a list), so they need not all be held in memory at once.
+ */
+cell_list : cell { driver.add_cell(std::move($1)); }
+          | cell_list cell  { driver.add_cell(std::move($2)); }
           ;
 
 sdf_version : LPAR SDFVERSION Qid RPAR { $$ = $3; }
@@ -187,57 +209,63 @@ hierarchy_divider : LPAR DIVIDER Id RPAR { $$ = $3; }
 timescale : LPAR TIMESCALE Float Id RPAR { $$ = Timescale($3, $4); }
           ;
 
-cell : LPAR CELL celltype instance timing_check RPAR { $$ = Cell($3, $4, Delay(), $5); }
-     | LPAR CELL celltype instance delay RPAR { $$ = Cell($3, $4, $5, TimingCheck()); }
+cell : LPAR CELL celltype instance timing_check RPAR { $$ = Cell($3, $4, Delay(), std::move($5)); }
+     | LPAR CELL celltype instance delay RPAR { $$ = Cell($3, $4, std::move($5), TimingCheck()); }
      | LPAR CELL celltype instance RPAR { $$ = Cell($3, $4, Delay(), TimingCheck()); }
-     | LPAR CELL celltype instance delay timing_check RPAR { $$ = Cell($3, $4, Delay(), TimingCheck()); }
+     | LPAR CELL celltype instance delay timing_check RPAR { $$ = Cell($3, $4, std::move($5), std::move($6)); }
      ;
 
-celltype : LPAR CELLTYPE Qid RPAR { $$ = $3; }
+celltype : LPAR CELLTYPE Qid RPAR { $$ = driver.intern(std::move($3)); }
          ;
 
-instance : LPAR INSTANCE Id RPAR { $$ = $3; }
+instance : LPAR INSTANCE Id RPAR { $$ = driver.scratch_instance(std::move($3)); }
          ;
 
-timing_check : LPAR TIMINGCHECK timing_check_list RPAR { $$ = TimingCheck($3); }
+/*
+ * List elements are appended to scratch vectors in the driver (which are
+ * re-used for every cell), and the enclosing rule takes a view of them.
+ * The driver copies the lists into the DelayFile's storage (see CellStorage)
+ * when the cell is complete.
+ */
+timing_check : LPAR TIMINGCHECK timing_check_list RPAR { $$ = TimingCheck(ArrayView<Timing>(driver.timing_checks_)); }
              ;
 
-timing_check_list : t_check { $$ = std::vector<Timing>(); $$.push_back($1); }
-                | timing_check_list t_check { $$ = $1; $$.push_back($2); }
+timing_check_list : t_check { driver.timing_checks_.push_back($1); }
+                | timing_check_list t_check { driver.timing_checks_.push_back($2); }
                 ;
 
-t_check: removal_check
-       | recovery_check
-       | hold_check
-       | setup_check
+t_check: removal_check { $$ = std::move($1); }
+       | recovery_check { $$ = std::move($1); }
+       | hold_check { $$ = std::move($1); }
+       | setup_check { $$ = std::move($1); }
        ;
 
-removal_check : LPAR REMOVAL port_spec port_spec real_triple RPAR { $$ = Timing($4, $3, $5, "REMOVAL"); }
+removal_check : LPAR REMOVAL port_spec port_spec real_triple RPAR { $$ = Timing(std::move($4), std::move($3), $5, TimingType::REMOVAL); }
 
-recovery_check : LPAR RECOVERY port_spec port_spec real_triple RPAR { $$ = Timing($4, $3, $5, "RECOVERY"); }
+recovery_check : LPAR RECOVERY port_spec port_spec real_triple RPAR { $$ = Timing(std::move($4), std::move($3), $5, TimingType::RECOVERY); }
 
-hold_check : LPAR HOLD port_spec port_spec real_triple RPAR { $$ = Timing($4, $3, $5, "HOLD"); }
+hold_check : LPAR HOLD port_spec port_spec real_triple RPAR { $$ = Timing(std::move($4), std::move($3), $5, TimingType::HOLD); }
 
-setup_check : LPAR SETUP port_spec port_spec real_triple RPAR { $$ = Timing($4, $3, $5, "SETUP"); }
+setup_check : LPAR SETUP port_spec port_spec real_triple RPAR { $$ = Timing(std::move($4), std::move($3), $5, TimingType::SETUP); }
 
 
-delay : LPAR DELAY absolute RPAR { $$ = Delay(Delay::Type::ABSOLUTE, $3); }
+delay : LPAR DELAY absolute RPAR { $$ = Delay(Delay::Type::ABSOLUTE, ArrayView<Iopath>(driver.iopaths_)); }
       ;
 
-absolute : LPAR ABSOLUTE RPAR { $$ = std::vector<Iopath>(); } 
-         | LPAR ABSOLUTE iopath_list RPAR { $$ = $3; }
+absolute : LPAR ABSOLUTE RPAR
+         | LPAR ABSOLUTE iopath_list RPAR
          ;
 
-iopath_list : iopath             { $$ = std::vector<Iopath>(); $$.push_back($1); }
-            | iopath_list iopath { $1.push_back($2); $$ = $1; }
+iopath_list : iopath
+            | iopath_list iopath
             ;
 
-iopath : LPAR IOPATH port_spec port_spec real_triple real_triple RPAR { $$ = Iopath($3, $4, $5, $6); }
+iopath : LPAR IOPATH port_spec port_spec real_triple real_triple RPAR { driver.iopaths_.push_back(Iopath($3, $4, $5, $6)); }
        ;
 
-port_spec : Id { $$ = PortSpec($1, PortCondition::NONE); }
-          | LPAR port_condition Id RPAR { $$ = PortSpec($3, $2); }
-          | Float { $$ = PortSpec(std::to_string((int)$1), PortCondition::NONE); }
+port_spec : Id { $$ = PortSpec(driver.intern(std::move($1)), PortCondition::NONE); }
+          | LPAR port_condition Id RPAR { $$ = PortSpec(driver.intern(std::move($3)), $2); }
+          | Float { $$ = PortSpec(driver.intern(std::to_string((int)$1)), PortCondition::NONE); }
           ;
 
 port_condition: POSEDGE { $$ = PortCondition::POSEDGE; }
@@ -250,8 +278,8 @@ real_triple : LPAR Float COLON Float COLON Float RPAR { $$ = RealTriple($2, $4,
             ;
 
 
-Id : String { $$ = unescape_sdf_identifier($1); }
-Qid : Qstring { $$ = unescape_sdf_identifier($1); }
+Id : String { $$ = driver.unescape(std::move($1)); }
+Qid : Qstring { $$ = driver.unescape(std::move($1)); }
 
 %%
 
@@ -0,0 +1,244 @@
+#include "sdf_pipe.hpp"
+#include "sdf_mmap.hpp"
+#include "sdf_posix_io.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#if SDFPARSE_HAVE_POSIX_IO
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace /*anonymous*/ {
+
+#if SDFPARSE_HAVE_POSIX_IO
+
+//Reads a file with POSIX I/O, keeping the OS reading ahead of the reader
+class FileSource : public sdfparse::ByteSource {
+    public:
+        explicit FileSource(const std::string& filename)
+            : fd_(::open(filename.c_str(), O_RDONLY)) {
+            if(fd_ < 0) {
+                throw std::runtime_error("Failed to open file");
+            }
+#ifdef POSIX_FADV_SEQUENTIAL
+            //Enlarges the kernel's own read-ahead
+            posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+            advise_read_ahead();
+        }
+
+        ~FileSource() {
+            ::close(fd_);
+        }
+
+        FileSource(const FileSource&) = delete;
+        FileSource& operator=(const FileSource&) = delete;
+
+        size_t read(char* buf, size_t size) override {
+            while(true) {
+                ssize_t num_read = ::read(fd_, buf, size);
+                if(num_read >= 0) {
+                    offset_ += num_read;
+                    if(offset_ + READ_AHEAD_WINDOW / 2 >= advised_end_) {
+                        advise_read_ahead();
+                    }
+                    return num_read;
+                } else if(errno != EINTR) {
+                    throw std::runtime_error(std::string("Failed to read file: ") + std::strerror(errno));
+                }
+            }
+        }
+
+    private:
+        //Asks the OS to start reading the next window of the file
+        void advise_read_ahead() {
+#ifdef POSIX_FADV_WILLNEED
+            posix_fadvise(fd_, advised_end_, READ_AHEAD_WINDOW, POSIX_FADV_WILLNEED);
+#endif
+            advised_end_ += READ_AHEAD_WINDOW;
+        }
+
+    private:
+        static constexpr off_t READ_AHEAD_WINDOW = 16 << 20;
+
+        int fd_;
+        off_t offset_ = 0; //Offset of the next read
+        off_t advised_end_ = 0; //End of the range the OS has been asked to read ahead
+};
+
+#else
+
+//Reads a file with stdio
+class FileSource : public sdfparse::ByteSource {
+    public:
+        explicit FileSource(const std::string& filename)
+            : file_(std::fopen(filename.c_str(), "rb")) {
+            if(!file_) {
+                throw std::runtime_error("Failed to open file");
+            }
+        }
+
+        ~FileSource() {
+            std::fclose(file_);
+        }
+
+        FileSource(const FileSource&) = delete;
+        FileSource& operator=(const FileSource&) = delete;
+
+        size_t read(char* buf, size_t size) override {
+            size_t num_read = std::fread(buf, 1, size, file_);
+            if(num_read == 0 && std::ferror(file_)) {
+                throw std::runtime_error("Failed to read file");
+            }
+            return num_read;
+        }
+
+    private:
+        std::FILE* file_;
+};
+
+#endif
+
+} //namespace
+
+namespace sdfparse {
+
+std::unique_ptr<ByteSource> open_file_source(const std::string& filename) {
+    return std::unique_ptr<ByteSource>(new FileSource(filename));
+}
+
+constexpr size_t PipeStreambuf::DEFAULT_BLOCK_SIZE;
+constexpr size_t PipeStreambuf::DEFAULT_NUM_BLOCKS;
+constexpr size_t PipeStreambuf::BLOCK_ALIGNMENT;
+constexpr size_t PipeStreambuf::NO_BLOCK;
+
+PipeStreambuf::PipeStreambuf(std::unique_ptr<ByteSource> source, size_t block_size, size_t num_blocks)
+    : source_(std::move(source))
+    , block_size_((block_size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT)
+    , block_sizes_(num_blocks, 0) {
+    assert(source_);
+    assert(num_blocks > 0);
+
+    storage_.reset(new char[num_blocks * block_size_ + BLOCK_ALIGNMENT]);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(storage_.get());
+    blocks_ = storage_.get() + (BLOCK_ALIGNMENT - addr % BLOCK_ALIGNMENT) % BLOCK_ALIGNMENT;
+
+    for(size_t block = 0; block < num_blocks; ++block) {
+        free_blocks_.push_back(block);
+    }
+
+    //Nothing is buffered until the first underflow()
+    setg(nullptr, nullptr, nullptr);
+
+    thread_ = std::thread(&PipeStreambuf::produce, this);
+}
+
+PipeStreambuf::~PipeStreambuf() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    free_cv_.notify_all();
+    thread_.join();
+}
+
+bool PipeStreambuf::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !error_.empty();
+}
+
+std::string PipeStreambuf::error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+PipeStreambuf::int_type PipeStreambuf::underflow() {
+    if(gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    //The current block has been consumed, hand it back to the producer
+    if(current_block_ != NO_BLOCK) {
+        free_blocks_.push_back(current_block_);
+        current_block_ = NO_BLOCK;
+        free_cv_.notify_one();
+    }
+
+    filled_cv_.wait(lock, [&]() { return !filled_blocks_.empty() || done_; });
+    if(filled_blocks_.empty()) {
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+
+    current_block_ = filled_blocks_.front();
+    filled_blocks_.pop_front();
+
+    char* data = block_data(current_block_);
+    setg(data, data, data + block_sizes_[current_block_]);
+    return traits_type::to_int_type(*data);
+}
+
+void PipeStreambuf::produce() {
+    try {
+        while(true) {
+            size_t block;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                free_cv_.wait(lock, [&]() { return !free_blocks_.empty() || stop_; });
+                if(stop_) return;
+
+                block = free_blocks_.front();
+                free_blocks_.pop_front();
+            }
+
+            //Fill the block completely (unless the input ends),
+            //so the consumer sees as few blocks as possible
+            char* data = block_data(block);
+            size_t size = 0;
+            bool exhausted = false;
+            while(size < block_size_) {
+                size_t num_read = source_->read(data + size, block_size_ - size);
+                if(num_read == 0) {
+                    exhausted = true;
+                    break;
+                }
+                size += num_read;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                block_sizes_[block] = size;
+                if(size > 0) {
+                    filled_blocks_.push_back(block);
+                } else {
+                    free_blocks_.push_back(block);
+                }
+                done_ = exhausted;
+            }
+            filled_cv_.notify_one();
+
+            if(exhausted) return;
+        }
+    } catch(std::exception& error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = error.what();
+            if(error_.empty()) {
+                error_ = "Failed to read input";
+            }
+            done_ = true;
+        }
+        filled_cv_.notify_one();
+    }
+}
+
+} //sdfparse
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdfparse {
+
+//A sequential source of bytes (e.g. a file or a decompressor)
+class ByteSource {
+    public:
+        virtual ~ByteSource() = default;
+
+        //Reads up to size bytes into buf, returning the number of bytes read
+        //(0 once the input is exhausted). Failures are thrown as std::runtime_error.
+        virtual size_t read(char* buf, size_t size) = 0;
+};
+
+//Returns a source which reads the file sequentially, advising the OS to
+//read ahead of it where supported. Throws std::runtime_error if the file
+//can not be opened.
+std::unique_ptr<ByteSource> open_file_source(const std::string& filename);
+
+//A stream buffer which reads from a ByteSource on a separate thread
+//
+//The producer thread fills up to num_blocks blocks ahead of the consumer
+//(a bounded queue), so reading (e.g. decompressing) the input overlaps with
+//whatever the consumer does with it. An error reading the source ends the
+//stream early; it can be checked for with failed() once the end of the
+//stream has been reached.
+class PipeStreambuf : public std::streambuf {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+        static constexpr size_t DEFAULT_NUM_BLOCKS = 4;
+
+        //Blocks are aligned to this many bytes (suitable for direct I/O)
+        static constexpr size_t BLOCK_ALIGNMENT = 4096;
+
+        explicit PipeStreambuf(std::unique_ptr<ByteSource> source,
+                               size_t block_size=DEFAULT_BLOCK_SIZE,
+                               size_t num_blocks=DEFAULT_NUM_BLOCKS);
+        ~PipeStreambuf();
+
+        PipeStreambuf(const PipeStreambuf&) = delete;
+        PipeStreambuf& operator=(const PipeStreambuf&) = delete;
+
+        //Whether reading the source failed, and why
+        bool failed() const;
+        std::string error() const;
+
+    protected:
+        int_type underflow() override;
+
+    private:
+        //Fills blocks from the source until it is exhausted (run by thread_)
+        void produce();
+
+        char* block_data(size_t block) { return blocks_ + block * block_size_; }
+
+    private:
+        static constexpr size_t NO_BLOCK = size_t(-1);
+
+        std::unique_ptr<ByteSource> source_;
+        size_t block_size_;
+
+        std::unique_ptr<char[]> storage_;
+        char* blocks_ = nullptr; //Start of the (aligned) blocks within storage_
+        std::vector<size_t> block_sizes_; //Number of valid bytes in each filled block
+        size_t current_block_ = NO_BLOCK; //Block being read by the consumer
+
+        mutable std::mutex mutex_;
+        std::condition_variable free_cv_; //Signalled when a block is freed (or on stop)
+        std::condition_variable filled_cv_; //Signalled when a block is filled (or on done)
+        std::deque<size_t> free_blocks_;
+        std::deque<size_t> filled_blocks_;
+        bool done_ = false; //The producer has finished (no more blocks will be filled)
+        bool stop_ = false; //The consumer has gone away
+        std::string error_;
+
+        std::thread thread_;
+};
+
+} //sdfparse
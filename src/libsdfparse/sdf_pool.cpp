@@ -0,0 +1,170 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "sdf_pool.hpp"
+#include "sdf_error.hpp"
+
+namespace /*anonymous*/ {
+
+//Never the bit pattern of a (canonical) value, so marks unused hash table slots
+constexpr uint64_t EMPTY_BITS = ~uint64_t(0);
+
+uint64_t value_bits(double value);
+uint64_t pair_key(uint32_t rise, uint32_t fall);
+
+//Returns the bit pattern of the value, with all NaNs made the same
+uint64_t value_bits(double value) {
+    if(std::isnan(value)) {
+        value = std::numeric_limits<double>::quiet_NaN();
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint64_t pair_key(uint32_t rise, uint32_t fall) {
+    return (uint64_t(rise) << 32) | fall;
+}
+
+} //namespace
+
+namespace sdfparse {
+
+constexpr TriplePool::Ref TriplePool::SCALAR;
+constexpr size_t TriplePool::MAX_ENTRIES;
+constexpr PooledDelayFile::DelayCode PooledDelayFile::PAIR;
+
+size_t TriplePool::TripleBitsHash::operator()(const TripleBits& bits) const {
+    std::hash<uint64_t> hash;
+    size_t seed = hash(bits.min);
+    seed ^= hash(bits.typ) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= hash(bits.max) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+TriplePool::TriplePool()
+    : scalar_refs_(EMPTY_BITS)
+    , triple_refs_(TripleBits{EMPTY_BITS, EMPTY_BITS, EMPTY_BITS}) {
+}
+
+TriplePool::Ref TriplePool::intern(const RealTriple& triple) {
+    TripleBits bits = {value_bits(triple.min()), value_bits(triple.typ()), value_bits(triple.max())};
+
+    if(bits.min == bits.typ && bits.min == bits.max) {
+        if(const Ref* ref = scalar_refs_.find(bits.min)) {
+            return *ref;
+        }
+        if(scalars_.size() == MAX_ENTRIES) {
+            throw std::length_error("Too many distinct delay values");
+        }
+        Ref ref = static_cast<Ref>(scalars_.size()) | SCALAR;
+        scalars_.push_back(triple.min());
+        scalar_refs_.insert(bits.min, ref);
+        return ref;
+    }
+
+    if(const Ref* ref = triple_refs_.find(bits)) {
+        return *ref;
+    }
+    if(triples_.size() == MAX_ENTRIES) {
+        throw std::length_error("Too many distinct delay values");
+    }
+    Ref ref = static_cast<Ref>(triples_.size());
+    triples_.push_back(triple);
+    triple_refs_.insert(bits, ref);
+    return ref;
+}
+
+PooledDelayFile::PooledDelayFile(const DelayFile& delayfile) {
+    header_ = delayfile.header();
+    symbols_ = delayfile.shared_symbols();
+
+    FlatSizes sizes = reserve_structure(delayfile);
+    delay_codes_.reserve(sizes.num_iopaths);
+    timing_t_refs_.reserve(sizes.num_timings);
+
+    for(const Cell& cell : delayfile.cells()) {
+        add_cell(cell, cell.instance_symbol());
+    }
+}
+
+TriplePool::Ref PooledDelayFile::rise_ref(size_t iopath) const {
+    DelayCode code = delay_codes_[iopath];
+    return (code & PAIR) ? pairs_[code & ~PAIR].first : code;
+}
+
+TriplePool::Ref PooledDelayFile::fall_ref(size_t iopath) const {
+    DelayCode code = delay_codes_[iopath];
+    return (code & PAIR) ? pairs_[code & ~PAIR].second : code;
+}
+
+size_t PooledDelayFile::delay_bytes() const {
+    return pool_.value_bytes()
+           + delay_codes_.size() * sizeof(DelayCode)
+           + timing_t_refs_.size() * sizeof(TriplePool::Ref)
+           + pairs_.size() * sizeof(pairs_[0]);
+}
+
+size_t PooledDelayFile::plain_delay_bytes() const {
+    return (2 * num_iopaths() + num_timings()) * sizeof(RealTriple);
+}
+
+double PooledDelayFile::compression_ratio() const {
+    size_t plain_bytes = plain_delay_bytes();
+    return plain_bytes ? double(delay_bytes()) / plain_bytes : 1.;
+}
+
+void PooledDelayFile::add_cell(const Cell& cell, Symbol instance) {
+    //Intern first, so a failure leaves the cell out entirely
+    ArrayView<Iopath> iopaths = cell.delay().iopaths();
+    ArrayView<Timing> timings = cell.timing_check().timing();
+    size_t num_iopaths = delay_codes_.size();
+    size_t num_timings = timing_t_refs_.size();
+    try {
+        for(const Iopath& iopath : iopaths) {
+            delay_codes_.push_back(intern_delay(iopath.rise(), iopath.fall()));
+        }
+        for(const Timing& timing : timings) {
+            timing_t_refs_.push_back(pool_.intern(timing.t()));
+        }
+    } catch(...) {
+        delay_codes_.resize(num_iopaths);
+        timing_t_refs_.resize(num_timings);
+        throw;
+    }
+
+    add_structure(cell, instance);
+}
+
+PooledDelayFile::DelayCode PooledDelayFile::intern_delay(const RealTriple& rise, const RealTriple& fall) {
+    TriplePool::Ref rise_ref = pool_.intern(rise);
+    TriplePool::Ref fall_ref = pool_.intern(fall);
+    if(rise_ref == fall_ref) {
+        return rise_ref;
+    }
+
+    //Refs are never equal in a pair, so the key is never that of an unused slot (0)
+    uint64_t key = pair_key(rise_ref, fall_ref);
+    if(const DelayCode* code = pair_codes_.find(key)) {
+        return *code;
+    }
+    if(pairs_.size() == PAIR) {
+        throw std::length_error("Too many distinct rise/fall delay pairs");
+    }
+    DelayCode code = static_cast<DelayCode>(pairs_.size()) | PAIR;
+    pairs_.emplace_back(rise_ref, fall_ref);
+    pair_codes_.insert(key, code);
+    return code;
+}
+
+void PooledLoader::on_cell(Cell&& cell) {
+    try {
+        add_cell(cell);
+    } catch(std::length_error& error) {
+        throw ParseError(error.what(), current_location());
+    }
+}
+
+} //sdfparse
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_flat.hpp"
+#include "sdf_hash_map.hpp"
+#include "sdf_loader.hpp"
+
+namespace sdfparse {
+
+//A table of distinct RealTriples (hash-consed)
+//
+//Each distinct triple is stored once and referred to by a small Ref.
+//Scalar triples (min == typ == max, including the empty triple) are
+//stored as a single value, marked by the SCALAR flag in their Ref.
+//Values are compared bitwise, so e.g. all empty (NaN) values are equal.
+class TriplePool {
+    public:
+        typedef uint32_t Ref;
+
+        //Set in the Refs of scalar triples
+        static constexpr Ref SCALAR = Ref(1) << 30;
+
+        //The maximum number of distinct scalars (or non-scalar triples)
+        static constexpr size_t MAX_ENTRIES = SCALAR;
+
+        TriplePool();
+
+        //Returns the Ref of the triple, adding it to the pool if required.
+        //Throws std::length_error if the pool is full.
+        Ref intern(const RealTriple& triple);
+
+        RealTriple get(Ref ref) const {
+            if(ref & SCALAR) {
+                double value = scalars_[ref & ~SCALAR];
+                return RealTriple(value, value, value);
+            }
+            return triples_[ref];
+        }
+
+        size_t num_scalars() const { return scalars_.size(); }
+        size_t num_triples() const { return triples_.size(); }
+
+        //Bytes used to store the values (excluding the hash tables used to find them)
+        size_t value_bytes() const { return scalars_.size() * sizeof(double) + triples_.size() * sizeof(RealTriple); }
+
+    private:
+        //The bit patterns of a triple's values
+        struct TripleBits {
+            uint64_t min;
+            uint64_t typ;
+            uint64_t max;
+
+            friend bool operator==(const TripleBits& lhs, const TripleBits& rhs) {
+                return lhs.min == rhs.min && lhs.typ == rhs.typ && lhs.max == rhs.max;
+            }
+        };
+
+        struct TripleBitsHash {
+            size_t operator()(const TripleBits& bits) const;
+        };
+
+    private:
+        std::vector<double> scalars_;
+        std::vector<RealTriple> triples_;
+        OpenHashMap<uint64_t, Ref> scalar_refs_;
+        OpenHashMap<TripleBits, Ref, TripleBitsHash> triple_refs_;
+};
+
+//A structure-of-arrays representation of a DelayFile (see FlatStructure)
+//whose delay values are deduplicated
+//
+//Real SDF files repeat a few distinct values across many arcs, most of
+//which are scalar (min == typ == max) with equal rise and fall delays.
+//So the values are kept in a TriplePool, and each IOPATH stores a single
+//32-bit delay code: the (shared) Ref of its delay if rise == fall, or
+//otherwise (with the PAIR flag set) the index of its distinct (rise, fall)
+//pair of Refs. This takes 4 bytes per IOPATH rather than the 48 of two
+//RealTriples, and lets whole-design sweeps work on the few distinct values.
+//Files whose values are mostly distinct gain nothing, and may use more
+//space (check compression_ratio() and use a FlatDelayFile instead if it
+//is above 1).
+//
+//A PooledDelayFile can be converted from a DelayFile, or built directly
+//while parsing with a PooledLoader (which deduplicates the values as they
+//are parsed).
+class PooledDelayFile : public FlatStructure {
+    public:
+        typedef uint32_t DelayCode;
+
+        //Set in the delay codes of IOPATHs whose rise and fall delays differ
+        static constexpr DelayCode PAIR = DelayCode(1) << 31;
+
+        PooledDelayFile() = default;
+
+        //Throws std::length_error if there are too many distinct values
+        explicit PooledDelayFile(const DelayFile& delayfile);
+
+        //IOPATH values
+        DelayCode delay_code(size_t iopath) const { return delay_codes_[iopath]; }
+        bool symmetric(size_t iopath) const { return !(delay_codes_[iopath] & PAIR); } //rise == fall
+        TriplePool::Ref rise_ref(size_t iopath) const;
+        TriplePool::Ref fall_ref(size_t iopath) const;
+        RealTriple rise(size_t iopath) const { return pool_.get(rise_ref(iopath)); }
+        RealTriple fall(size_t iopath) const { return pool_.get(fall_ref(iopath)); }
+
+        //Timing check values
+        TriplePool::Ref timing_t_ref(size_t timing) const { return timing_t_refs_[timing]; }
+        RealTriple timing_t(size_t timing) const { return pool_.get(timing_t_refs_[timing]); }
+
+        //The distinct values
+        const TriplePool& pool() const { return pool_; }
+
+        //The number of distinct (rise, fall) pairs of IOPATHs whose rise and fall differ
+        size_t num_pairs() const { return pairs_.size(); }
+
+        //Bytes used to store the delay values (including the pool, but not
+        //the hash tables used to build it)
+        size_t delay_bytes() const;
+
+        //Bytes the delay values would take as RealTriples (e.g. in a
+        //FlatDelayFile)
+        size_t plain_delay_bytes() const;
+
+        //delay_bytes() / plain_delay_bytes(): below 1 if pooling saves space
+        double compression_ratio() const;
+
+    private:
+        friend class FlatStructureLoader<PooledDelayFile>;
+
+        void add_cell(const Cell& cell, Symbol instance); //instance is the cell's (interned) instance
+
+        DelayCode intern_delay(const RealTriple& rise, const RealTriple& fall);
+
+    private:
+        std::vector<DelayCode> delay_codes_;
+        std::vector<TriplePool::Ref> timing_t_refs_;
+
+        TriplePool pool_;
+        std::vector<std::pair<TriplePool::Ref, TriplePool::Ref>> pairs_; //Distinct (rise, fall) pairs
+        OpenHashMap<uint64_t, DelayCode> pair_codes_; //Index of each pair (with both Refs packed into the key)
+};
+
+//A Loader which builds a PooledDelayFile directly as the file is parsed
+//(without building the intermediate DelayFile cells). Running out of
+//space for distinct values is reported as an error.
+class PooledLoader : public FlatStructureLoader<PooledDelayFile> {
+    public:
+        const PooledDelayFile& get_pooled_delayfile() const { return delayfile_; }
+
+    protected:
+        void on_cell(Cell&& cell) override;
+};
+
+} //sdfparse
@@ -0,0 +1,13 @@
+#pragma once
+
+//POSIX file I/O (open()/read()/write() on file descriptors, stat()) is used
+//where available, independently of memory mapping (see sdf_mmap.hpp). The
+//build defines SDFPARSE_HAVE_POSIX_IO after checking for it; otherwise it
+//is assumed on POSIX-like systems.
+#ifndef SDFPARSE_HAVE_POSIX_IO
+# if defined(__unix__) || defined(__APPLE__)
+#  define SDFPARSE_HAVE_POSIX_IO 1
+# else
+#  define SDFPARSE_HAVE_POSIX_IO 0
+# endif
+#endif
@@ -0,0 +1,49 @@
+#include "sdf_symbol.hpp"
+
+namespace sdfparse {
+
+const std::string& Symbol::empty_string() {
+    static const std::string empty;
+    return empty;
+}
+
+Symbol SymbolTable::intern(const std::string& str) {
+    Shard& str_shard = shard(str);
+    std::lock_guard<std::mutex> lock(str_shard.mutex);
+
+    //Strings in an unordered_set are never moved, so pointers to them remain valid
+    auto iter = str_shard.strings.insert(str).first;
+    return Symbol(&*iter);
+}
+
+Symbol SymbolTable::intern(std::string&& str) {
+    Shard& str_shard = shard(str);
+    std::lock_guard<std::mutex> lock(str_shard.mutex);
+
+    auto iter = str_shard.strings.insert(std::move(str)).first;
+    return Symbol(&*iter);
+}
+
+Symbol SymbolTable::find(const std::string& str) const {
+    const Shard& str_shard = shard(str);
+    std::lock_guard<std::mutex> lock(str_shard.mutex);
+
+    auto iter = str_shard.strings.find(str);
+    if(iter == str_shard.strings.end()) {
+        return Symbol();
+    }
+    return Symbol(&*iter);
+}
+
+size_t SymbolTable::size() const {
+    size_t num_strings = 0;
+    for(const Shard& str_shard : shards_) {
+        std::lock_guard<std::mutex> lock(str_shard.mutex);
+        num_strings += str_shard.strings.size();
+    }
+    return num_strings;
+}
+
+constexpr size_t SymbolTable::NUM_SHARDS;
+
+} //sdfparse
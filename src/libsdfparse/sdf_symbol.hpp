@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <unordered_set>
+#include <functional>
+
+namespace sdfparse {
+
+//An interned string
+//
+//Symbols are created by a SymbolTable, which stores each distinct string
+//once. Symbols from the same SymbolTable are equal if and only if their
+//strings are equal, so comparing (or hashing) them does not touch the
+//strings themselves.
+//
+//A Symbol is only valid while the SymbolTable which created it exists.
+class Symbol {
+    public:
+        //A null symbol (whose string is empty)
+        Symbol() = default;
+
+        //The interned string
+        const std::string& str() const { return str_ ? *str_ : empty_string(); }
+
+        bool is_null() const { return str_ == nullptr; }
+
+        friend bool operator==(Symbol lhs, Symbol rhs) { return lhs.str_ == rhs.str_; }
+        friend bool operator!=(Symbol lhs, Symbol rhs) { return lhs.str_ != rhs.str_; }
+
+    private:
+        friend class SymbolTable;
+        friend class Loader; //Refers to a scratch string for each cell's instance (see Loader::intern_instance())
+        friend struct std::hash<Symbol>;
+
+        explicit Symbol(const std::string* str) : str_(str) {}
+
+        static const std::string& empty_string();
+
+    private:
+        const std::string* str_ = nullptr;
+};
+
+//A table of interned strings
+//
+//Interning is thread-safe: the table is split into independently locked
+//shards so concurrent parsers can share it with little contention.
+class SymbolTable {
+    public:
+        SymbolTable() = default;
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        //Returns the symbol for str, adding it to the table if required
+        Symbol intern(const std::string& str);
+        Symbol intern(std::string&& str);
+
+        //Returns the symbol for str, or a null Symbol if it is not in the table
+        Symbol find(const std::string& str) const;
+
+        //The number of distinct strings
+        size_t size() const;
+
+    private:
+        static constexpr size_t NUM_SHARDS = 64;
+
+        struct Shard {
+            mutable std::mutex mutex;
+            std::unordered_set<std::string> strings;
+        };
+
+        Shard& shard(const std::string& str) { return shards_[std::hash<std::string>()(str) % NUM_SHARDS]; }
+        const Shard& shard(const std::string& str) const { return shards_[std::hash<std::string>()(str) % NUM_SHARDS]; }
+
+    private:
+        Shard shards_[NUM_SHARDS];
+};
+
+} //sdfparse
+
+namespace std {
+    template<>
+    struct hash<sdfparse::Symbol> {
+        size_t operator()(sdfparse::Symbol symbol) const {
+            return std::hash<const std::string*>()(symbol.str_);
+        }
+    };
+}
@@ -0,0 +1,222 @@
+#include <algorithm>
+
+#include "sdf_transform.hpp"
+#include "sdf_parallel.hpp"
+
+namespace /*anonymous*/ {
+
+//Number of cells transformed by each parallel work item
+constexpr size_t CELLS_PER_BLOCK = 512;
+
+//Number of values (of each column) transformed by each parallel work item,
+//small enough that a block's columns stay in cache between steps
+constexpr size_t VALUES_PER_BLOCK = 4096;
+
+size_t value_index(sdfparse::TripleValue value);
+void scale_clamp(double* values, size_t num_values, double factor, double lo, double hi);
+
+size_t value_index(sdfparse::TripleValue value) {
+    switch(value) {
+        case sdfparse::TripleValue::MIN: return 0;
+        case sdfparse::TripleValue::TYP: return 1;
+        case sdfparse::TripleValue::MAX: //Fall through
+        default: return 2;
+    }
+}
+
+//Written as a branch-free loop so it is vectorized. NaN values never compare
+//less or greater, so remain NaN.
+void scale_clamp(double* values, size_t num_values, double factor, double lo, double hi) {
+    for(size_t i = 0; i < num_values; ++i) {
+        double value = values[i] * factor;
+        value = (value < lo) ? lo : value;
+        value = (value > hi) ? hi : value;
+        values[i] = value;
+    }
+}
+
+} //namespace
+
+namespace sdfparse {
+
+//Applies DelayTransforms (and TripleFunctions) to the values of a file
+class DelayMutator {
+    public:
+        typedef DelayTransform::Step Step;
+
+        static RealTriple apply(const Step& step, const RealTriple& triple) {
+            double values[3] = {triple.min(), triple.typ(), triple.max()};
+            double result[3];
+            for(size_t i = 0; i < 3; ++i) {
+                double value = values[value_index(step.source[i])] * step.factor[i];
+                value = (value < step.lo) ? step.lo : value;
+                value = (value > step.hi) ? step.hi : value;
+                result[i] = value;
+            }
+            return RealTriple(result[0], result[1], result[2]);
+        }
+
+        template<typename Func>
+        static void transform(DelayFile& delayfile, const Func& func, unsigned targets, size_t num_threads) {
+            //Copies any lists shared with other files before they are modified
+            //concurrently
+            delayfile.make_lists_writable();
+
+            size_t num_cells = delayfile.cells().size();
+            size_t num_blocks = (num_cells + CELLS_PER_BLOCK - 1) / CELLS_PER_BLOCK;
+
+            parallel_for(num_blocks, num_threads, [&](size_t block) {
+                size_t end = std::min(num_cells, (block + 1) * CELLS_PER_BLOCK);
+                for(size_t icell = block * CELLS_PER_BLOCK; icell < end; ++icell) {
+                    for(Iopath& iopath : delayfile.mutable_iopaths(icell)) {
+                        if(targets & TRANSFORM_RISE) iopath.set_rise(func(iopath.rise()));
+                        if(targets & TRANSFORM_FALL) iopath.set_fall(func(iopath.fall()));
+                    }
+
+                    if(targets & TRANSFORM_TIMING) {
+                        for(Timing& timing : delayfile.mutable_timing(icell)) {
+                            timing.set_t(func(timing.t()));
+                        }
+                    }
+                }
+            });
+        }
+
+        //Calls func(columns, begin, end) on blocks of each of the targeted columns
+        template<typename Func>
+        static void for_each_block(FlatDelayFile& flat_delayfile, unsigned targets, size_t num_threads, const Func& func) {
+            std::vector<TripleColumns*> targeted;
+            if(targets & TRANSFORM_RISE) targeted.push_back(&flat_delayfile.mutable_rise());
+            if(targets & TRANSFORM_FALL) targeted.push_back(&flat_delayfile.mutable_fall());
+            if(targets & TRANSFORM_TIMING) targeted.push_back(&flat_delayfile.mutable_timing_t());
+
+            //Work items are the blocks of each column in turn
+            std::vector<std::pair<TripleColumns*, size_t>> blocks;
+            for(TripleColumns* columns : targeted) {
+                for(size_t begin = 0; begin < columns->size(); begin += VALUES_PER_BLOCK) {
+                    blocks.emplace_back(columns, begin);
+                }
+            }
+
+            parallel_for(blocks.size(), num_threads, [&](size_t i) {
+                TripleColumns& columns = *blocks[i].first;
+                size_t begin = blocks[i].second;
+                func(columns, begin, std::min(columns.size(), begin + VALUES_PER_BLOCK));
+            });
+        }
+
+        static void transform(FlatDelayFile& flat_delayfile, const DelayTransform& transform,
+                              unsigned targets, size_t num_threads) {
+            const std::vector<Step>& steps = transform.steps_;
+            for_each_block(flat_delayfile, targets, num_threads, [&](TripleColumns& columns, size_t begin, size_t end) {
+                size_t num_values = end - begin;
+                double* values[3] = {columns.min.data() + begin, columns.typ.data() + begin, columns.max.data() + begin};
+
+                std::vector<double> previous;
+                for(const Step& step : steps) {
+                    bool permuted = false;
+                    for(size_t i = 0; i < 3; ++i) {
+                        permuted |= (value_index(step.source[i]) != i);
+                    }
+                    if(permuted) {
+                        //Copy the previous values, so they can be read in any order
+                        previous.resize(3 * num_values);
+                        for(size_t i = 0; i < 3; ++i) {
+                            std::copy(values[i], values[i] + num_values, previous.data() + i * num_values);
+                        }
+                        for(size_t i = 0; i < 3; ++i) {
+                            const double* source = previous.data() + value_index(step.source[i]) * num_values;
+                            std::copy(source, source + num_values, values[i]);
+                        }
+                    }
+
+                    for(size_t i = 0; i < 3; ++i) {
+                        scale_clamp(values[i], num_values, step.factor[i], step.lo, step.hi);
+                    }
+                }
+            });
+        }
+
+        static void transform(FlatDelayFile& flat_delayfile, const TripleFunction& func,
+                              unsigned targets, size_t num_threads) {
+            for_each_block(flat_delayfile, targets, num_threads, [&](TripleColumns& columns, size_t begin, size_t end) {
+                for(size_t i = begin; i < end; ++i) {
+                    RealTriple triple = func(columns[i]);
+                    columns.min[i] = triple.min();
+                    columns.typ[i] = triple.typ();
+                    columns.max[i] = triple.max();
+                }
+            });
+        }
+};
+
+DelayTransform::Step DelayTransform::identity_step() {
+    double inf = std::numeric_limits<double>::infinity();
+    return Step{{TripleValue::MIN, TripleValue::TYP, TripleValue::MAX}, {1., 1., 1.}, -inf, inf};
+}
+
+DelayTransform DelayTransform::scale(double factor) {
+    return derate(factor, factor, factor);
+}
+
+DelayTransform DelayTransform::derate(double min_factor, double typ_factor, double max_factor) {
+    Step step = identity_step();
+    step.factor[0] = min_factor;
+    step.factor[1] = typ_factor;
+    step.factor[2] = max_factor;
+
+    DelayTransform transform;
+    transform.steps_.push_back(step);
+    return transform;
+}
+
+DelayTransform DelayTransform::clamp(double lo, double hi) {
+    Step step = identity_step();
+    step.lo = lo;
+    step.hi = hi;
+
+    DelayTransform transform;
+    transform.steps_.push_back(step);
+    return transform;
+}
+
+DelayTransform DelayTransform::select(TripleValue value) {
+    Step step = identity_step();
+    step.source[0] = step.source[1] = step.source[2] = value;
+
+    DelayTransform transform;
+    transform.steps_.push_back(step);
+    return transform;
+}
+
+DelayTransform DelayTransform::then(const DelayTransform& next) const {
+    DelayTransform transform = *this;
+    transform.steps_.insert(transform.steps_.end(), next.steps_.begin(), next.steps_.end());
+    return transform;
+}
+
+RealTriple DelayTransform::operator()(const RealTriple& triple) const {
+    RealTriple result = triple;
+    for(const Step& step : steps_) {
+        result = DelayMutator::apply(step, result);
+    }
+    return result;
+}
+
+void transform_delays(DelayFile& delayfile, const DelayTransform& transform, unsigned targets, size_t num_threads) {
+    DelayMutator::transform(delayfile, transform, targets, num_threads);
+}
+
+void transform_delays(DelayFile& delayfile, const TripleFunction& func, unsigned targets, size_t num_threads) {
+    DelayMutator::transform(delayfile, func, targets, num_threads);
+}
+
+void transform_delays(FlatDelayFile& flat_delayfile, const DelayTransform& transform, unsigned targets, size_t num_threads) {
+    DelayMutator::transform(flat_delayfile, transform, targets, num_threads);
+}
+
+void transform_delays(FlatDelayFile& flat_delayfile, const TripleFunction& func, unsigned targets, size_t num_threads) {
+    DelayMutator::transform(flat_delayfile, func, targets, num_threads);
+}
+
+} //sdfparse
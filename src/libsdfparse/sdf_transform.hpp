@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "sdf_data.hpp"
+#include "sdf_flat.hpp"
+
+namespace sdfparse {
+
+//Selects the values a transformation is applied to (combined with |)
+enum TransformTarget : unsigned {
+    TRANSFORM_RISE   = 1 << 0, //IOPATH rise delays
+    TRANSFORM_FALL   = 1 << 1, //IOPATH fall delays
+    TRANSFORM_TIMING = 1 << 2, //Timing check values
+    TRANSFORM_ALL    = TRANSFORM_RISE | TRANSFORM_FALL | TRANSFORM_TIMING
+};
+
+//A transformation of min:typ:max delay values, built from a sequence of
+//built-in steps (e.g. DelayTransform::derate(0.9, 1., 1.1).then(DelayTransform::clamp(0.)))
+//
+//Each step sets each of min/typ/max to one of the (previous) values, scaled
+//and then clamped, so a whole sequence is applied in a single pass over the
+//data. Empty (NaN) values remain empty.
+class DelayTransform {
+    public:
+        //The identity transformation
+        DelayTransform() = default;
+
+        //Multiplies all values by factor
+        static DelayTransform scale(double factor);
+
+        //Multiplies the min, typ and max values by separate factors
+        //(e.g. early and late OCV derates)
+        static DelayTransform derate(double min_factor, double typ_factor, double max_factor);
+
+        //Clamps all values to [lo, hi] (e.g. clamp(0.) removes negative delays)
+        static DelayTransform clamp(double lo, double hi=std::numeric_limits<double>::infinity());
+
+        //Sets min, typ and max to the selected value (e.g. to pick one corner)
+        static DelayTransform select(TripleValue value);
+
+        //Returns the transformation which applies this and then next
+        DelayTransform then(const DelayTransform& next) const;
+
+        RealTriple operator()(const RealTriple& triple) const;
+
+    private:
+        friend class DelayMutator;
+
+        struct Step {
+            TripleValue source[3]; //Which previous value each of min/typ/max is taken from
+            double factor[3];
+            double lo;
+            double hi;
+        };
+
+        static Step identity_step();
+
+    private:
+        std::vector<Step> steps_;
+};
+
+//A user-supplied transformation, which must be safe to call concurrently
+typedef std::function<RealTriple(const RealTriple&)> TripleFunction;
+
+//Transforms the targeted values of every IOPATH and timing check in place,
+//using up to num_threads threads (0 uses one per hardware thread).
+//
+//Lists of a DelayFile which are shared with its copies (or stored
+//elsewhere) are first copied (see DelayFile::make_lists_writable()), so
+//its copies are unaffected. The values must not be accessed by other
+//threads during the transformation.
+//
+//Transforming a FlatDelayFile is fastest, since its values are stored
+//column-wise: each step is a vectorized loop over blocks of each column,
+//so a sequence of steps is a single sweep limited by memory bandwidth.
+void transform_delays(DelayFile& delayfile, const DelayTransform& transform,
+                      unsigned targets=TRANSFORM_ALL, size_t num_threads=0);
+void transform_delays(DelayFile& delayfile, const TripleFunction& func,
+                      unsigned targets=TRANSFORM_ALL, size_t num_threads=0);
+void transform_delays(FlatDelayFile& flat_delayfile, const DelayTransform& transform,
+                      unsigned targets=TRANSFORM_ALL, size_t num_threads=0);
+void transform_delays(FlatDelayFile& flat_delayfile, const TripleFunction& func,
+                      unsigned targets=TRANSFORM_ALL, size_t num_threads=0);
+
+} //sdfparse
@@ -0,0 +1,523 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ostream>
+
+#include "sdf_writer.hpp"
+
+#if SDFPARSE_HAVE_POSIX_IO
+# include <fcntl.h>
+# include <unistd.h>
+#else
+# include <fstream>
+#endif
+
+namespace /*anonymous*/ {
+
+constexpr size_t BUFFER_SIZE = 64 << 10;
+
+//Large enough for any formatted double (e.g. 1e308 in fixed notation)
+constexpr size_t MAX_NUMBER_CHARS = 400;
+
+//Indentation for up to MAX_INDENT_DEPTH levels is written from this
+constexpr int MAX_INDENT_DEPTH = 32;
+const char INDENT_SPACES[2 * MAX_INDENT_DEPTH + 1] = "                                                                ";
+
+size_t format_integer(int64_t value, char* out);
+bool format_decimal(double value, double max_magnitude, double min_abs_value, char* out, size_t& len);
+size_t format_shortest(double value, char* out);
+size_t format_iostream(double value, char* out);
+
+//Writes value (which must be non-negative, or the negation of one) in decimal
+size_t format_integer(int64_t value, char* out) {
+    char digits[20];
+    size_t num_digits = 0;
+
+    uint64_t magnitude = (value < 0) ? uint64_t(0) - uint64_t(value) : uint64_t(value);
+    do {
+        digits[num_digits++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude != 0);
+
+    size_t len = 0;
+    if(value < 0) {
+        out[len++] = '-';
+    }
+    while(num_digits > 0) {
+        out[len++] = digits[--num_digits];
+    }
+    return len;
+}
+
+//Fast path for the common case of values with only a few decimal places
+//
+//If value is the double nearest to n / 10^k (for some integer n with
+//|n| < max_magnitude, and k <= 9), writes n / 10^k in fixed notation
+//(using the smallest such k, so without trailing zeros) and returns true.
+//Since the division is correctly rounded, that decimal reads back as
+//exactly value. Returns false if there is no such n, or |value| is
+//smaller than min_abs_value (or is negative zero).
+bool format_decimal(double value, double max_magnitude, double min_abs_value, char* out, size_t& len) {
+    static const double POWERS_OF_10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+    if(value == 0.) {
+        if(std::signbit(value)) {
+            return false;
+        }
+        out[0] = '0';
+        len = 1;
+        return true;
+    }
+    if(!(std::fabs(value) >= min_abs_value)) {
+        return false; //Also rejects NaN
+    }
+
+    for(int k = 0; k < 10; ++k) {
+        double scaled = value * POWERS_OF_10[k];
+        if(!(std::fabs(scaled) < max_magnitude)) {
+            return false;
+        }
+
+        double n = std::round(scaled);
+        if(n / POWERS_OF_10[k] != value) {
+            continue;
+        }
+
+        char digits[24];
+        size_t num_digits = format_integer(int64_t(std::fabs(n)), digits);
+
+        len = 0;
+        if(value < 0.) {
+            out[len++] = '-';
+        }
+        if(num_digits <= size_t(k)) {
+            //Less than one
+            out[len++] = '0';
+            out[len++] = '.';
+            for(size_t i = num_digits; i < size_t(k); ++i) {
+                out[len++] = '0';
+            }
+            std::memcpy(out + len, digits, num_digits);
+            len += num_digits;
+        } else {
+            size_t num_integer_digits = num_digits - k;
+            std::memcpy(out + len, digits, num_integer_digits);
+            len += num_integer_digits;
+            if(k > 0) {
+                out[len++] = '.';
+                std::memcpy(out + len, digits + num_integer_digits, k);
+                len += k;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+//Writes value in fixed notation using the fewest significant digits
+//(at most 17) which read back as exactly value
+size_t format_shortest(double value, char* out) {
+    if(!std::isfinite(value)) {
+        return std::snprintf(out, MAX_NUMBER_CHARS, "%g", value);
+    }
+
+    //Most delays are whole numbers, or have only a few decimal places
+    size_t decimal_len;
+    if(format_decimal(value, 1e15, 0., out, decimal_len)) {
+        return decimal_len;
+    }
+
+    //Find the fewest digits which round-trip. Values which were read from
+    //a decimal with 15 or fewer significant digits always round-trip at 15.
+    char sci[32];
+    for(int precision = 15; precision <= 17; ++precision) {
+        std::snprintf(sci, sizeof(sci), "%.*e", precision - 1, value);
+        if(std::strtod(sci, nullptr) == value) {
+            break;
+        }
+    }
+
+    //Split sci ("-d.ddde+XX") into its digits and exponent
+    const char* pos = sci;
+    bool negative = (*pos == '-');
+    if(negative) {
+        ++pos;
+    }
+    char digits[20];
+    int num_digits = 0;
+    for(; *pos != 'e'; ++pos) {
+        if(*pos != '.') {
+            digits[num_digits++] = *pos;
+        }
+    }
+    int exponent = std::atoi(pos + 1);
+
+    //Trailing zeros are not significant
+    while(num_digits > 1 && digits[num_digits - 1] == '0') {
+        --num_digits;
+    }
+
+    //Write as fixed notation
+    size_t len = 0;
+    if(negative) {
+        out[len++] = '-';
+    }
+    if(exponent < 0) {
+        out[len++] = '0';
+        out[len++] = '.';
+        for(int i = -1; i > exponent; --i) {
+            out[len++] = '0';
+        }
+        std::memcpy(out + len, digits, num_digits);
+        len += num_digits;
+    } else {
+        int num_integer_digits = exponent + 1;
+        for(int i = 0; i < num_integer_digits; ++i) {
+            out[len++] = (i < num_digits) ? digits[i] : '0';
+        }
+        if(num_digits > num_integer_digits) {
+            out[len++] = '.';
+            std::memcpy(out + len, digits + num_integer_digits, num_digits - num_integer_digits);
+            len += num_digits - num_integer_digits;
+        }
+    }
+    return len;
+}
+
+//Writes value as an ostream would by default (i.e. "%g")
+size_t format_iostream(double value, char* out) {
+    //%g writes values with at most 6 significant digits, and a decimal
+    //exponent of at least -4, in fixed notation without trailing zeros
+    size_t len;
+    if(format_decimal(value, 1e6, 1e-4, out, len)) {
+        return len;
+    }
+    return std::snprintf(out, MAX_NUMBER_CHARS, "%g", value);
+}
+
+} //namespace
+
+namespace sdfparse {
+
+Writer::Writer(std::ostream& os, WriteFormat format)
+    : os_(&os)
+    , format_(format)
+    , buf_(new char[BUFFER_SIZE])
+    , pos_(buf_.get())
+    , end_(buf_.get() + BUFFER_SIZE) {
+}
+
+#if SDFPARSE_HAVE_POSIX_IO
+Writer::Writer(int fd, WriteFormat format)
+    : fd_(fd)
+    , format_(format)
+    , buf_(new char[BUFFER_SIZE])
+    , pos_(buf_.get())
+    , end_(buf_.get() + BUFFER_SIZE) {
+}
+#endif
+
+Writer::~Writer() {
+    flush();
+}
+
+void Writer::write(const DelayFile& delayfile, int depth) {
+    put_indent(depth);
+    put("(DELAYFILE\n");
+
+    write(delayfile.header(), depth+1);
+
+    for(const Cell& cell : delayfile.cells()) {
+        write(cell, depth+1);
+    }
+
+    put_indent(depth);
+    put(")\n");
+}
+
+void Writer::write(const Header& header, int depth) {
+    put_indent(depth);
+    put("(SDFVERSION \"");
+    put(header.sdfversion());
+    put("\")\n");
+
+    put_header_string(depth, "DESIGN", header.design());
+    put_header_string(depth, "VENDOR", header.vendor());
+    put_header_string(depth, "PROGRAM", header.program());
+    put_header_string(depth, "VERSION", header.version());
+
+    put_indent(depth);
+    put("(DIVIDER ");
+    put(header.divider());
+    put(")\n");
+
+    write(header.timescale(), depth);
+}
+
+void Writer::write(const Timescale& timescale, int depth) {
+    put_indent(depth);
+    put("(TIMESCALE ");
+    put_number(timescale.value());
+    put(' ');
+    put(timescale.unit());
+    put(")\n");
+}
+
+void Writer::write(const Cell& cell, int depth) {
+    put_indent(depth);
+    put("(CELL\n");
+
+    put_indent(depth+1);
+    put("(CELLTYPE \"");
+    put_identifier(cell.celltype(), EscapeStyle::ALL_CHARS);
+    put("\")\n");
+
+    put_indent(depth+1);
+    put("(INSTANCE ");
+    put_identifier(cell.instance(), EscapeStyle::ALL_CHARS);
+    put(")\n");
+
+    write(cell.delay(), depth+1);
+    write(cell.timing_check(), depth+1);
+
+    put_indent(depth);
+    put(")\n");
+}
+
+void Writer::write(const Delay& delay, int depth) {
+    if(delay.iopaths().empty()) {
+        return;
+    }
+
+    put_indent(depth);
+    put("(DELAY\n");
+
+    put_indent(depth+1);
+    put('(');
+    assert(delay.type() == Delay::Type::ABSOLUTE);
+    put("ABSOLUTE\n");
+
+    for(const Iopath& iopath : delay.iopaths()) {
+        write(iopath, depth+2);
+    }
+
+    put_indent(depth+1);
+    put(")\n");
+    put_indent(depth);
+    put(")\n");
+}
+
+void Writer::write(const Iopath& iopath, int depth) {
+    put_indent(depth);
+    put("(IOPATH ");
+    put_port_spec(iopath.input());
+    put(' ');
+    put_port_spec(iopath.output());
+    put(' ');
+    put_real_triple(iopath.rise());
+    put(' ');
+    put_real_triple(iopath.fall());
+    put(")\n");
+}
+
+void Writer::write(const TimingCheck& timing_check, int depth) {
+    if(timing_check.timing().empty()) {
+        return;
+    }
+
+    put_indent(depth);
+    put("(TIMINGCHECK\n");
+
+    for(const Timing& timing : timing_check.timing()) {
+        write(timing, depth+1);
+    }
+
+    put_indent(depth);
+    put(")\n");
+}
+
+void Writer::write(const Timing& timing, int depth) {
+    put_indent(depth);
+    if(format_ == WriteFormat::COMPATIBLE) {
+        put(timing.type());
+    } else {
+        put('(');
+        put(timing.type());
+        put(' ');
+    }
+    put_port_spec(timing.port());
+    put(' ');
+    put_port_spec(timing.clock());
+    put(' ');
+    put_real_triple(timing.t());
+    put(")\n");
+}
+
+bool Writer::flush() {
+    flush_buffer();
+
+    if(os_) {
+        os_->flush();
+        if(!*os_) {
+            good_ = false;
+        }
+    }
+    return good_;
+}
+
+void Writer::put(const char* str, size_t size) {
+    while(size > 0) {
+        if(pos_ == end_) {
+            flush_buffer();
+        }
+        size_t chunk = std::min(size, size_t(end_ - pos_));
+        std::memcpy(pos_, str, chunk);
+        pos_ += chunk;
+        str += chunk;
+        size -= chunk;
+    }
+}
+
+void Writer::put(const char* str) {
+    put(str, std::strlen(str));
+}
+
+void Writer::put_indent(int depth) {
+    for(; depth > MAX_INDENT_DEPTH; depth -= MAX_INDENT_DEPTH) {
+        put(INDENT_SPACES, 2 * MAX_INDENT_DEPTH);
+    }
+    put(INDENT_SPACES, 2 * depth);
+}
+
+void Writer::put_header_string(int depth, const char* keyword, const std::string& value) {
+    //Empty strings can not be read back, but these entries are optional
+    if(format_ != WriteFormat::COMPATIBLE && value.empty()) {
+        return;
+    }
+
+    put_indent(depth);
+    put('(');
+    put(keyword);
+    put(" \"");
+    put(value);
+    put("\")\n");
+}
+
+void Writer::put_identifier(const std::string& identifier, EscapeStyle style) {
+    const char* str = identifier.data();
+    size_t len = identifier.size();
+
+    if(2 * len <= BUFFER_SIZE) {
+        //Escape directly into the buffer (each character expands to at most two)
+        reserve(2 * len);
+        pos_ += escape_sdf_identifier(str, len, pos_, style);
+        return;
+    }
+
+    //Very long identifier, escape in pieces
+    size_t end = sdf_escape_end(str, len, style);
+    for(size_t i = 0; i < end; ++i) {
+        if(is_special_sdf_char(str[i])) {
+            put('\\');
+        }
+        put(str[i]);
+    }
+    put(str + end, len - end);
+}
+
+void Writer::put_number(double value) {
+    reserve(MAX_NUMBER_CHARS);
+    if(format_ == WriteFormat::COMPATIBLE) {
+        pos_ += format_iostream(value, pos_);
+    } else {
+        pos_ += format_shortest(value, pos_);
+    }
+}
+
+void Writer::put_real_triple(const RealTriple& triple) {
+    if(std::isnan(triple.min()) && std::isnan(triple.typ()) && std::isnan(triple.max())) {
+        put("()");
+    } else {
+        put('(');
+        put_number(triple.min());
+        put(':');
+        put_number(triple.typ());
+        put(':');
+        put_number(triple.max());
+        put(')');
+    }
+}
+
+void Writer::put_port_spec(const PortSpec& port_spec) {
+    if(port_spec.condition() == PortCondition::POSEDGE) {
+        put("(posedge ");
+    } else if(port_spec.condition() == PortCondition::NEGEDGE) {
+        put("(negedge ");
+    }
+
+    put_identifier(port_spec.port(), EscapeStyle::EXCLUDE_LAST_INDEX);
+
+    if(port_spec.condition() != PortCondition::NONE) {
+        put(')');
+    }
+}
+
+void Writer::flush_buffer() {
+    const char* data = buf_.get();
+    size_t size = pos_ - data;
+    pos_ = buf_.get();
+
+    if(!good_ || size == 0) {
+        return;
+    }
+
+    if(os_) {
+        if(!os_->write(data, size)) {
+            good_ = false;
+        }
+        return;
+    }
+
+#if SDFPARSE_HAVE_POSIX_IO
+    while(size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            good_ = false;
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+#endif
+}
+
+bool write_sdf_file(const std::string& filename, const DelayFile& delayfile, WriteFormat format) {
+#if SDFPARSE_HAVE_POSIX_IO
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(fd < 0) {
+        return false;
+    }
+
+    bool success;
+    {
+        Writer writer(fd, format);
+        writer.write(delayfile);
+        success = writer.flush();
+    }
+    return (::close(fd) == 0) && success;
+#else
+    std::ofstream os(filename, std::ios::binary);
+    Writer writer(os, format);
+    writer.write(delayfile);
+    return writer.flush();
+#endif
+}
+
+} //sdfparse
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+#include "sdf_data.hpp"
+#include "sdf_escape.hpp"
+#include "sdf_posix_io.hpp"
+
+namespace sdfparse {
+
+//The style of output produced by a Writer
+enum class WriteFormat {
+    //Byte-identical to the original ostream-based print() output: numbers
+    //as written by iostreams (6 significant digits), and timing checks
+    //without their opening parenthesis
+    COMPATIBLE,
+
+    //Output which reads back as identical data: numbers are written with
+    //the fewest digits (in fixed notation) which round-trip exactly, and
+    //empty optional header entries are omitted
+    ROUNDTRIP
+};
+
+//A buffered SDF writer
+//
+//Output is formatted into a large buffer which is written out (to an
+//ostream or a file descriptor) when full, so writing avoids the iostream
+//formatting machinery and per-line allocations. Identifiers are escaped
+//directly into the buffer.
+//
+//The print() methods of the SDF data classes use a Writer (with
+//WriteFormat::COMPATIBLE).
+class Writer {
+    public:
+        explicit Writer(std::ostream& os, WriteFormat format=WriteFormat::ROUNDTRIP);
+#if SDFPARSE_HAVE_POSIX_IO
+        //Writes to a file descriptor (which remains owned by the caller)
+        explicit Writer(int fd, WriteFormat format=WriteFormat::ROUNDTRIP);
+#endif
+        ~Writer(); //Flushes
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        void write(const DelayFile& delayfile, int depth=0);
+        void write(const Header& header, int depth=0);
+        void write(const Timescale& timescale, int depth=0);
+        void write(const Cell& cell, int depth=0);
+        void write(const Delay& delay, int depth=0);
+        void write(const Iopath& iopath, int depth=0);
+        void write(const TimingCheck& timing_check, int depth=0);
+        void write(const Timing& timing, int depth=0);
+
+        //Writes out any buffered output, returning false if an error has occurred
+        bool flush();
+
+        //Returns false if an error has occurred while writing out
+        bool good() const { return good_; }
+
+    private:
+        void put(char c) {
+            if(pos_ == end_) {
+                flush_buffer();
+            }
+            *pos_++ = c;
+        }
+        void put(const char* str, size_t size);
+        void put(const char* str);
+        void put(const std::string& str) { put(str.data(), str.size()); }
+
+        void put_indent(int depth);
+        void put_header_string(int depth, const char* keyword, const std::string& value);
+        void put_identifier(const std::string& identifier, EscapeStyle style);
+        void put_number(double value);
+        void put_real_triple(const RealTriple& triple);
+        void put_port_spec(const PortSpec& port_spec);
+
+        //Ensures at least num_bytes are free in the buffer
+        void reserve(size_t num_bytes) {
+            if(size_t(end_ - pos_) < num_bytes) {
+                flush_buffer();
+            }
+        }
+        void flush_buffer();
+
+    private:
+        std::ostream* os_ = nullptr;
+        int fd_ = -1;
+        WriteFormat format_;
+        bool good_ = true;
+
+        std::unique_ptr<char[]> buf_;
+        char* pos_;
+        char* end_;
+};
+
+//Writes delayfile to the specified file, returning true if successful
+bool write_sdf_file(const std::string& filename, const DelayFile& delayfile, WriteFormat format=WriteFormat::ROUNDTRIP);
+
+} //sdfparse
@@ -2,3 +2,14 @@
 
 #include "sdf_loader.hpp"
 #include "sdf_data.hpp"
+#include "sdf_flat.hpp"
+#include "sdf_cache.hpp"
+#include "sdf_writer.hpp"
+#include "sdf_lazy.hpp"
+#include "sdf_batch.hpp"
+#include "sdf_corners.hpp"
+#include "sdf_fixed.hpp"
+#include "sdf_pool.hpp"
+#include "sdf_transform.hpp"
+#include "sdf_instance_tree.hpp"
+#include "sdf_diff.hpp"
@@ -0,0 +1,684 @@
+//Benchmarks loading (and using) an SDF file
+//
+//Each benchmark reports its run time, the peak resident set size of the
+//process after running it, and where meaningful the throughput in MB/s
+//(of SDF text) and cells/s. Since peak RSS only increases, run a single
+//benchmark per process (--bench) to attribute it to that benchmark.
+//
+//Synthetic inputs of any size can be produced with sdfparse_gen.
+//
+//With --cold the file is evicted from the OS page cache before each run of
+//the loading benchmarks, to measure throughput when it must be read from
+//storage (eviction needs posix_fadvise(), and may be ignored on some
+//filesystems).
+//
+//The storage benchmark compares CellStorage::HEAP and CellStorage::ARENA,
+//each loaded in a child process so its peak RSS is measured separately.
+//
+//With --scaling N no input file is needed: files of N, 4N and 16N cells are
+//generated, loaded with load_mapped(), and the exit code is non-zero if
+//the time per cell grows super-linearly (as it did when the parser copied
+//its lists on every reduction).
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "sdfparse.hpp"
+#include "sdf_mmap.hpp"
+#include "sdf_parallel.hpp"
+#include "sdf_lexer.hpp"
+#include "sdf_flex_lexer.hpp"
+#include "sdf_fast_lexer.hpp"
+#include "sdf_parser.gen.hpp"
+
+namespace /*anonymous*/ {
+
+using namespace sdfparse;
+
+struct Options {
+    std::string filename;
+    LexerType lexer_type = LexerType::FAST;
+    CellStorage cell_storage = CellStorage::HEAP;
+    size_t num_threads = 0;
+    size_t repeat = 1;
+    bool cold = false;
+    size_t scaling_cells = 0; //Base size of the scaling check (0 if not run)
+    std::vector<std::string> benchmarks;
+};
+
+//Statistics about the file being benchmarked
+struct FileInfo {
+    size_t size = 0;
+    size_t num_cells = 0;
+    size_t num_iopaths = 0;
+};
+
+//A Loader which parses, but discards the cells (to separate parsing from
+//building the DelayFile)
+class DiscardingLoader : public Loader {
+    protected:
+        void on_cell(Cell&& /*cell*/) override {}
+};
+
+//A Loader which rethrows errors, so benchmarks stop on bad input
+class CheckedLoader : public Loader {
+    protected:
+        void on_error(ParseError& error) override { throw error; }
+};
+
+//A BatchLoader which rethrows errors
+class CheckedBatchLoader : public BatchLoader {
+    protected:
+        void on_error(size_t /*ifile*/, ParseError& error) override { throw error; }
+};
+
+//The results of loading with a CellStorage (see bench_storage())
+struct StorageResult {
+    double load = 0.;
+    double destroy = 0.;
+    long rss_kib = 0; //Increase in peak RSS
+};
+
+typedef std::function<void()> BenchFunc;
+
+double time_seconds(const BenchFunc& func, size_t repeat, const BenchFunc& setup=BenchFunc());
+void evict_file(const std::string& filename);
+long peak_rss_kib();
+void report(const std::string& name, double seconds, const FileInfo& info, bool per_byte, bool per_cell);
+void print_usage(const char* prog);
+bool parse_args(int argc, char** argv, Options& options);
+size_t lex_file(const std::string& filename, LexerType lexer_type);
+StorageResult bench_storage(const Options& options, CellStorage storage);
+void run_benchmarks(const Options& options);
+std::string write_scaling_file(size_t num_cells);
+bool check_scaling(const Options& options);
+
+//Returns the fastest of repeat runs of func, calling setup (if any)
+//before each run
+double time_seconds(const BenchFunc& func, size_t repeat, const BenchFunc& setup) {
+    double best = 0.;
+    for(size_t i = 0; i < repeat; ++i) {
+        if(setup) {
+            setup();
+        }
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        if(i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+//Evicts the file's (clean) pages from the OS page cache
+void evict_file(const std::string& filename) {
+#ifdef POSIX_FADV_DONTNEED
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#else
+    (void) filename;
+#endif
+}
+
+long peak_rss_kib() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; //Bytes on macOS
+#else
+    return usage.ru_maxrss; //KiB on Linux
+#endif
+}
+
+void report(const std::string& name, double seconds, const FileInfo& info, bool per_byte, bool per_cell) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-16s %10.4f s", name.c_str(), seconds);
+    std::cout << line;
+    if(per_byte && seconds > 0.) {
+        std::snprintf(line, sizeof(line), " %10.1f MB/s", info.size / seconds / 1e6);
+        std::cout << line;
+    } else {
+        std::cout << "                ";
+    }
+    if(per_cell && seconds > 0.) {
+        std::snprintf(line, sizeof(line), " %12.0f cells/s", info.num_cells / seconds);
+        std::cout << line;
+    } else {
+        std::cout << "                      ";
+    }
+    std::snprintf(line, sizeof(line), " %10.1f MiB peak RSS", peak_rss_kib() / 1024.);
+    std::cout << line << std::endl;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options] sdf_file\n"
+              << "       " << prog << " [options] --scaling N [sdf_file]\n"
+              << "  --lexer flex|fast    Lexer to use (default: fast)\n"
+              << "  --storage heap|arena Cell list storage for loads (default: heap)\n"
+              << "  --threads N          Threads for parallel and batch loading (default: one per hardware thread)\n"
+              << "  --repeat N           Report the fastest of N runs (default: 1)\n"
+              << "  --bench NAME         Run only the named benchmark (may be repeated)\n"
+              << "  --cold               Evict the file from the page cache before each load\n"
+              << "  --scaling N          Check that loading time is linear in files of N, 4N and 16N generated cells\n"
+              << "\n"
+              << "Benchmarks:\n"
+              << "  lex            Lex the (memory-mapped) file, discarding the tokens\n"
+              << "  parse          Lex and parse the file, discarding the cells\n"
+              << "  load           Load with Loader::load() (std::istream)\n"
+              << "  load_read_ahead Load with Loader::load() using a read-ahead I/O thread\n"
+              << "  load_mapped    Load with Loader::load_mapped()\n"
+              << "  load_parallel  Load with Loader::load_parallel()\n"
+              << "  load_batch     Load one copy of the file per thread with BatchLoader\n"
+              << "  load_cached    Reload from a binary cache with Loader::load_cached()\n"
+              << "  destroy        Destroy a loaded DelayFile\n"
+              << "  storage        Load and destroy with each CellStorage, in child processes\n"
+              << "  flat           Convert to a FlatDelayFile\n"
+              << "  index          Build the lookup index\n"
+              << "  lookup         Look up every cell by instance name\n"
+              << "  print          Write with DelayFile::print()\n"
+              << "  write          Write with Writer (WriteFormat::ROUNDTRIP)\n"
+              << "  escape         Escape every instance name\n"
+              << "  unescape       Unescape every (escaped) instance name\n"
+              << "\n"
+              << "By default all benchmarks are run, and the lex/parse/build phase\n"
+              << "breakdown of load_mapped is reported.\n";
+}
+
+bool parse_args(int argc, char** argv, Options& options) {
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg == "--cold") {
+            options.cold = true;
+        } else if(arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+            if(i + 1 >= argc) {
+                return false;
+            }
+            std::string value = argv[++i];
+            if(arg == "--lexer") {
+                if(value == "flex") {
+                    options.lexer_type = LexerType::FLEX;
+                } else if(value == "fast") {
+                    options.lexer_type = LexerType::FAST;
+                } else {
+                    return false;
+                }
+            } else if(arg == "--storage") {
+                if(value == "heap") {
+                    options.cell_storage = CellStorage::HEAP;
+                } else if(value == "arena") {
+                    options.cell_storage = CellStorage::ARENA;
+                } else {
+                    return false;
+                }
+            } else if(arg == "--threads") {
+                options.num_threads = std::strtoul(value.c_str(), nullptr, 10);
+            } else if(arg == "--repeat") {
+                options.repeat = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+            } else if(arg == "--bench") {
+                options.benchmarks.push_back(value);
+            } else if(arg == "--scaling") {
+                options.scaling_cells = std::strtoul(value.c_str(), nullptr, 10);
+                if(options.scaling_cells == 0) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        } else if(options.filename.empty()) {
+            options.filename = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.filename.empty() || options.scaling_cells > 0;
+}
+
+//Lexes the file, returning the number of tokens
+size_t lex_file(const std::string& filename, LexerType lexer_type) {
+    std::unique_ptr<Lexer> lexer;
+    if(lexer_type == LexerType::FAST) {
+        lexer.reset(new FastSdfLexer());
+    } else {
+        lexer.reset(new FlexSdfLexer());
+    }
+
+    MappedFile mapped_file;
+    if(!mapped_file.open(filename)) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    lexer->set_input(mapped_file.begin(), mapped_file.end());
+
+    std::string loc_filename = filename;
+    auto pos = position(&loc_filename);
+    location loc(pos, pos);
+    lexer->set_loc(loc);
+
+    size_t num_tokens = 0;
+    while(lexer->next_token().type_get() != 0) { //0 is end-of-file
+        ++num_tokens;
+    }
+
+    lexer->set_input(nullptr, nullptr);
+    return num_tokens;
+}
+
+//Loads (with load_mapped()) and destroys the file in a child process,
+//returning the fastest times and the child's peak RSS increase
+StorageResult bench_storage(const Options& options, CellStorage storage) {
+    int fds[2];
+    if(pipe(fds) != 0) {
+        throw std::runtime_error("Failed to create pipe");
+    }
+
+    pid_t pid = fork();
+    if(pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("Failed to fork");
+    }
+
+    if(pid == 0) {
+        //Child: memory inherited from the parent is excluded by measuring from here
+        close(fds[0]);
+        StorageResult result;
+        long start_rss = peak_rss_kib();
+        bool ok = true;
+        try {
+            for(size_t i = 0; i < options.repeat; ++i) {
+                std::unique_ptr<CheckedLoader> loader(new CheckedLoader());
+                loader->set_lexer_type(options.lexer_type);
+                loader->set_cell_storage(storage);
+                double load = time_seconds([&]() { loader->load_mapped(options.filename); }, 1);
+                double destroy = time_seconds([&]() { loader.reset(); }, 1);
+                if(i == 0 || load < result.load) result.load = load;
+                if(i == 0 || destroy < result.destroy) result.destroy = destroy;
+            }
+        } catch(...) {
+            ok = false;
+        }
+        result.rss_kib = peak_rss_kib() - start_rss;
+        ok = ok && write(fds[1], &result, sizeof(result)) == ssize_t(sizeof(result));
+        close(fds[1]);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    StorageResult result;
+    ssize_t num_read = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if(num_read != ssize_t(sizeof(result)) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("Storage benchmark failed");
+    }
+    return result;
+}
+
+void run_benchmarks(const Options& options) {
+    auto enabled = [&](const std::string& name) {
+        return options.benchmarks.empty()
+               || std::find(options.benchmarks.begin(), options.benchmarks.end(), name) != options.benchmarks.end();
+    };
+    bool all = options.benchmarks.empty();
+
+    auto new_loader = [&]() {
+        std::unique_ptr<CheckedLoader> loader(new CheckedLoader());
+        loader->set_lexer_type(options.lexer_type);
+        loader->set_cell_storage(options.cell_storage);
+        return loader;
+    };
+
+    //Run before each load, to measure cold-cache throughput
+    BenchFunc evict;
+    if(options.cold) {
+        evict = [&]() { evict_file(options.filename); };
+    }
+
+    //A reference load, used to describe the file and by the benchmarks
+    //which operate on a loaded DelayFile
+    FileInfo info;
+    std::unique_ptr<CheckedLoader> ref_loader = new_loader();
+    ref_loader->load_mapped(options.filename);
+    const DelayFile& delayfile = ref_loader->get_delayfile();
+    {
+        MappedFile mapped_file;
+        mapped_file.open(options.filename);
+        info.size = mapped_file.size();
+    }
+    info.num_cells = delayfile.cells().size();
+    for(const Cell& cell : delayfile.cells()) {
+        info.num_iopaths += cell.delay().iopaths().size();
+    }
+    std::cout << options.filename << ": " << info.size / 1e6 << " MB, "
+              << info.num_cells << " cells, " << info.num_iopaths << " IOPATHs, "
+              << delayfile.symbols().size() << " distinct names" << std::endl;
+
+    double lex_time = 0.;
+    double parse_time = 0.;
+    double load_mapped_time = 0.;
+
+    if(enabled("lex")) {
+        size_t num_tokens = 0;
+        lex_time = time_seconds([&]() { num_tokens = lex_file(options.filename, options.lexer_type); }, options.repeat);
+        report("lex", lex_time, info, true, true);
+        std::cout << "  " << num_tokens << " tokens, " << num_tokens / lex_time / 1e6 << " Mtokens/s" << std::endl;
+    }
+
+    if(enabled("parse")) {
+        parse_time = time_seconds([&]() {
+            DiscardingLoader loader;
+            loader.set_lexer_type(options.lexer_type);
+            loader.load_mapped(options.filename);
+        }, options.repeat);
+        report("parse", parse_time, info, true, true);
+    }
+
+    if(enabled("load")) {
+        double t = time_seconds([&]() { new_loader()->load(options.filename); }, options.repeat, evict);
+        report("load", t, info, true, true);
+    }
+
+    if(enabled("load_read_ahead")) {
+        double t = time_seconds([&]() {
+            std::unique_ptr<CheckedLoader> loader = new_loader();
+            loader->set_read_ahead(true);
+            loader->load(options.filename);
+        }, options.repeat, evict);
+        report("load_read_ahead", t, info, true, true);
+    }
+
+    if(enabled("load_mapped")) {
+        load_mapped_time = time_seconds([&]() { new_loader()->load_mapped(options.filename); }, options.repeat, evict);
+        report("load_mapped", load_mapped_time, info, true, true);
+    }
+
+    if(enabled("load_parallel")) {
+        double t = time_seconds([&]() { new_loader()->load_parallel(options.filename, options.num_threads); }, options.repeat, evict);
+        report("load_parallel", t, info, true, true);
+    }
+
+    if(enabled("load_batch")) {
+        //As if loading a set of equally sized files (e.g. one per corner);
+        //compare the throughput with load_mapped to see how it scales
+        size_t num_files = (options.num_threads > 0) ? options.num_threads : default_num_threads();
+        std::vector<std::string> filenames(num_files, options.filename);
+        FileInfo batch_info = info;
+        batch_info.size *= num_files;
+        batch_info.num_cells *= num_files;
+        double t = time_seconds([&]() {
+            CheckedBatchLoader loader;
+            loader.set_lexer_type(options.lexer_type);
+            loader.set_cell_storage(options.cell_storage);
+            loader.set_num_threads(options.num_threads);
+            loader.load(filenames);
+        }, options.repeat, evict);
+        report("load_batch", t, batch_info, true, true);
+        std::cout << "  " << num_files << " files" << std::endl;
+    }
+
+    if(enabled("load_cached")) {
+        std::string cache_filename = options.filename + ".bench.cache";
+        std::remove(cache_filename.c_str());
+        double write_time = time_seconds([&]() { new_loader()->load_cached(options.filename, cache_filename); }, 1);
+        report("cache_build", write_time, info, true, true);
+        double t = time_seconds([&]() { new_loader()->load_cached(options.filename, cache_filename); }, options.repeat);
+        report("load_cached", t, info, true, true);
+        std::remove(cache_filename.c_str());
+    }
+
+    if(enabled("destroy")) {
+        double total = 0.;
+        for(size_t i = 0; i < options.repeat; ++i) {
+            std::unique_ptr<CheckedLoader> loader = new_loader();
+            loader->load_mapped(options.filename);
+            total += time_seconds([&]() { loader.reset(); }, 1);
+        }
+        report("destroy", total / options.repeat, info, false, true);
+    }
+
+    if(enabled("storage")) {
+        const char* names[] = {"heap", "arena"};
+        CellStorage storages[] = {CellStorage::HEAP, CellStorage::ARENA};
+        for(size_t i = 0; i < 2; ++i) {
+            StorageResult result = bench_storage(options, storages[i]);
+            char line[256];
+            std::snprintf(line, sizeof(line), "storage %-8s load %10.4f s %10.1f MB/s  destroy %10.4f s  peak RSS +%.1f MiB",
+                          names[i], result.load, info.size / result.load / 1e6, result.destroy, result.rss_kib / 1024.);
+            std::cout << line << std::endl;
+        }
+    }
+
+    if(enabled("flat")) {
+        double t = time_seconds([&]() { FlatDelayFile flat(delayfile); }, options.repeat);
+        report("flat", t, info, false, true);
+    }
+
+    if(enabled("index")) {
+        //The index is built once per DelayFile, so time it on fresh
+        //(independent) copies
+        double best = 0.;
+        for(size_t i = 0; i < options.repeat; ++i) {
+            DelayFile copy = delayfile.clone();
+            double t = time_seconds([&]() { copy.build_index(); }, 1);
+            if(i == 0 || t < best) {
+                best = t;
+            }
+        }
+        report("index", best, info, false, true);
+    }
+
+    if(enabled("lookup")) {
+        delayfile.build_index();
+        size_t num_found = 0;
+        double t = time_seconds([&]() {
+            for(const Cell& cell : delayfile.cells()) {
+                num_found += (delayfile.find_cell(cell.instance()) != nullptr);
+            }
+        }, options.repeat);
+        report("lookup", t, info, false, true);
+        if(num_found != options.repeat * info.num_cells) {
+            throw std::runtime_error("Lookup failed");
+        }
+    }
+
+    if(enabled("print")) {
+        std::ofstream null_os("/dev/null");
+        double t = time_seconds([&]() { delayfile.print(null_os); }, options.repeat);
+        report("print", t, info, true, true);
+    }
+
+    if(enabled("write")) {
+        double t = time_seconds([&]() { write_sdf_file("/dev/null", delayfile); }, options.repeat);
+        report("write", t, info, true, true);
+    }
+
+    if(enabled("escape") || enabled("unescape")) {
+        //Realistic (hierarchical) names from the file
+        std::vector<std::string> names;
+        names.reserve(delayfile.cells().size());
+        for(const Cell& cell : delayfile.cells()) {
+            names.push_back(cell.instance());
+        }
+        std::vector<std::string> escaped;
+        escaped.reserve(names.size());
+        for(const std::string& name : names) {
+            escaped.push_back(escape_sdf_identifier(name));
+        }
+        size_t num_chars = 0;
+        for(const std::string& name : escaped) {
+            num_chars += name.size();
+        }
+
+        if(enabled("escape")) {
+            std::vector<char> buf;
+            size_t total = 0;
+            double t = time_seconds([&]() {
+                for(const std::string& name : names) {
+                    buf.resize(2 * name.size());
+                    total += escape_sdf_identifier(name.data(), name.size(), buf.data());
+                }
+            }, options.repeat);
+            (void) total;
+            report("escape", t, info, false, false);
+            std::cout << "  " << t / names.size() * 1e9 << " ns/name, " << num_chars / t / 1e6 << " MB/s" << std::endl;
+        }
+
+        if(enabled("unescape")) {
+            //Names are unescaped in place, so restore them (outside the
+            //timed region) before each run
+            std::vector<char> pristine;
+            std::vector<std::pair<size_t, size_t>> spans; //Offset and length of each name
+            pristine.reserve(num_chars);
+            spans.reserve(escaped.size());
+            for(const std::string& name : escaped) {
+                spans.emplace_back(pristine.size(), name.size());
+                pristine.insert(pristine.end(), name.begin(), name.end());
+            }
+            std::vector<char> work(pristine.size());
+
+            double best = 0.;
+            size_t total = 0;
+            for(size_t i = 0; i < options.repeat; ++i) {
+                std::copy(pristine.begin(), pristine.end(), work.begin());
+                double t = time_seconds([&]() {
+                    for(const auto& span : spans) {
+                        total += unescape_sdf_identifier_in_place(work.data() + span.first, span.second);
+                    }
+                }, 1);
+                if(i == 0 || t < best) {
+                    best = t;
+                }
+            }
+            (void) total;
+            report("unescape", best, info, false, false);
+            std::cout << "  " << best / names.size() * 1e9 << " ns/name, " << num_chars / best / 1e6 << " MB/s" << std::endl;
+        }
+    }
+
+    if(all) {
+        //Break loading down into phases
+        std::cout << "\nload_mapped phases:\n";
+        report("  lex", lex_time, info, true, true);
+        report("  parse", parse_time - lex_time, info, true, true);
+        report("  build", load_mapped_time - parse_time, info, true, true);
+    }
+}
+
+//Writes a file of num_cells cells (each with two IOPATHs and a timing
+//check) to a temporary file, returning its name
+std::string write_scaling_file(size_t num_cells) {
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string filename = std::string((tmpdir && *tmpdir) ? tmpdir : "/tmp") + "/sdfparse_scaling_XXXXXX";
+    int fd = mkstemp(&filename[0]);
+    if(fd < 0) {
+        throw std::runtime_error("Failed to create " + filename);
+    }
+    FILE* file = fdopen(fd, "w");
+    if(!file) {
+        close(fd);
+        throw std::runtime_error("Failed to open " + filename);
+    }
+
+    std::fprintf(file, "(DELAYFILE\n(SDFVERSION \"3.0\")\n(DESIGN \"scaling\")\n(DIVIDER /)\n(TIMESCALE 1 ps)\n");
+    for(size_t i = 0; i < num_cells; ++i) {
+        unsigned v = 10 + i % 90;
+        std::fprintf(file, "(CELL (CELLTYPE \"DFF_X%zu\") (INSTANCE top/u_%zu/reg_%zu)\n"
+                           "  (DELAY (ABSOLUTE (IOPATH CK Q (%u:%u:%u) (%u:%u:%u)) (IOPATH (posedge CK) QN (%u:%u:%u) (%u:%u:%u))))\n"
+                           "  (TIMINGCHECK (SETUP D (posedge CK) (%u:%u:%u))))\n",
+                     i % 4, i / 64, i, v, v + 1, v + 2, v, v + 1, v + 2, v, v + 1, v + 2, v, v + 1, v + 2, v, v, v);
+    }
+    std::fprintf(file, ")\n");
+    if(std::fclose(file) != 0) {
+        std::remove(filename.c_str());
+        throw std::runtime_error("Failed to write " + filename);
+    }
+    return filename;
+}
+
+//Loads generated files of increasing size, returning false if the time per
+//cell of the largest is more than MAX_GROWTH times that of the smallest
+//(a linear-time loader stays close to 1, a quadratic one grows ~16x)
+bool check_scaling(const Options& options) {
+    constexpr double MAX_GROWTH = 1.5;
+    constexpr size_t NUM_SIZES = 3;
+
+    std::vector<double> seconds_per_cell;
+    for(size_t i = 0, num_cells = options.scaling_cells; i < NUM_SIZES; ++i, num_cells *= 4) {
+        std::string filename = write_scaling_file(num_cells);
+        double t = 0.;
+        try {
+            //At least 3 runs, since small files are sensitive to noise
+            t = time_seconds([&]() {
+                CheckedLoader loader;
+                loader.set_lexer_type(options.lexer_type);
+                loader.load_mapped(filename);
+                if(loader.get_delayfile().cells().size() != num_cells) {
+                    throw std::runtime_error("Loaded the wrong number of cells from " + filename);
+                }
+            }, std::max<size_t>(options.repeat, 3));
+        } catch(...) {
+            std::remove(filename.c_str());
+            throw;
+        }
+        std::remove(filename.c_str());
+
+        seconds_per_cell.push_back(t / num_cells);
+        char line[256];
+        std::snprintf(line, sizeof(line), "scaling %10zu cells %10.4f s %8.1f ns/cell",
+                      num_cells, t, seconds_per_cell.back() * 1e9);
+        std::cout << line << std::endl;
+    }
+
+    double growth = seconds_per_cell.back() / seconds_per_cell.front();
+    bool linear = growth <= MAX_GROWTH;
+    std::cout << "scaling: time per cell grew " << growth << "x over a " << (1 << (2 * (NUM_SIZES - 1)))
+              << "x larger file (limit " << MAX_GROWTH << "x): " << (linear ? "OK" : "FAILED") << std::endl;
+    return linear;
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_args(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if(options.scaling_cells > 0 && !check_scaling(options)) {
+            return 1;
+        }
+        if(!options.filename.empty()) {
+            run_benchmarks(options);
+        }
+    } catch(ParseError& error) {
+        std::cerr << "SDF Error " << error.loc() << ": " << error.what() << "\n";
+        return 1;
+    } catch(std::exception& error) {
+        std::cerr << "Error: " << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,24 +1,43 @@
 #include <iostream>
+#include <cstring>
 
 #include "sdfparse.hpp"
 
 int main(int argc, char** argv) {
 
-    if(argc != 2) {
-        std::cout << "Usage: " << argv[0] << " sdf_file" << "\n";
+    bool print_stats = false;
+    const char* filename = nullptr;
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "--stats") == 0) {
+            print_stats = true;
+        } else if(!filename) {
+            filename = argv[i];
+        } else {
+            filename = nullptr;
+            break;
+        }
+    }
+
+    if(!filename) {
+        std::cout << "Usage: " << argv[0] << " [--stats] sdf_file" << "\n";
         return 1;
     }
 
     sdfparse::Loader sdf_loader;
-    bool loaded = sdf_loader.load(argv[1]);
+    sdf_loader.set_collect_stats(print_stats);
+    bool loaded = sdf_loader.load(filename);
     if(loaded) {
         std::cout << "Successfully loaded SDF\n";
 
-        auto delayfile = sdf_loader.get_delayfile();
+        const auto& delayfile = sdf_loader.get_delayfile();
         delayfile.print(std::cout);
-        return 0;
     } else {
         std::cout << "Failed to load SDF\n";
-        return 1;
     }
+
+    if(print_stats) {
+        //Keep the statistics separate from the printed SDF
+        sdf_loader.stats().print(std::cerr);
+    }
+    return loaded ? 0 : 1;
 }
@@ -0,0 +1,101 @@
+//Compares two SDF files (e.g. before and after an ECO)
+//
+//Cells are matched by instance and arcs by their ports, and values are
+//compared with optional absolute/relative tolerances. One line is printed
+//per added ('+'), removed ('-') or changed ('~') cell or arc, with values
+//in the first file's TIMESCALE units, followed by a summary. As with
+//diff, the exit code is 0 if the files match, 1 if they differ and 2 if
+//an error occurred.
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sdfparse.hpp"
+
+namespace /*anonymous*/ {
+
+struct Options {
+    sdfparse::DiffOptions diff;
+    bool summary_only = false;
+    bool fast_lexer = false;
+    std::vector<std::string> filenames;
+};
+
+void print_usage(const char* prog);
+bool parse_args(int argc, char** argv, Options& options);
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options] before.sdf after.sdf\n"
+              << "  --abs TOL           Absolute tolerance, in the first file's TIMESCALE units (default: 0)\n"
+              << "  --rel TOL           Relative tolerance (default: 0)\n"
+              << "  --no-timing-checks  Do not compare timing checks\n"
+              << "  --summary           Only print the summary\n"
+              << "  --fast-lexer        Use the hand-written lexer\n"
+              << "  --threads N         Threads to use (default: one per hardware thread)\n";
+}
+
+bool parse_args(int argc, char** argv, Options& options) {
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg == "--no-timing-checks") {
+            options.diff.compare_timing_checks = false;
+        } else if(arg == "--summary") {
+            options.summary_only = true;
+        } else if(arg == "--fast-lexer") {
+            options.fast_lexer = true;
+        } else if(arg == "--abs" || arg == "--rel" || arg == "--threads") {
+            if(i + 1 >= argc) {
+                return false;
+            }
+            const char* value = argv[++i];
+            if(arg == "--abs") {
+                options.diff.abs_tolerance = std::atof(value);
+            } else if(arg == "--rel") {
+                options.diff.rel_tolerance = std::atof(value);
+            } else {
+                options.diff.num_threads = std::strtoull(value, nullptr, 10);
+            }
+        } else if(arg.compare(0, 2, "--") == 0) {
+            return false;
+        } else {
+            options.filenames.push_back(arg);
+        }
+    }
+    return options.filenames.size() == 2;
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_args(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    //Load both files at once
+    sdfparse::BatchLoader loader;
+    loader.set_num_threads(options.diff.num_threads);
+    if(options.fast_lexer) {
+        loader.set_lexer_type(sdfparse::LexerType::FAST);
+    }
+    if(!loader.load(options.filenames)) {
+        return 2;
+    }
+    const std::vector<sdfparse::DelayFile>& delayfiles = loader.get_delayfiles();
+
+    try {
+        sdfparse::DelayFileDiff diff(delayfiles[0], delayfiles[1], options.diff);
+        if(!options.summary_only) {
+            diff.print(std::cout);
+        }
+        diff.print_summary(std::cout);
+        return diff.empty() ? 0 : 1;
+    } catch(std::invalid_argument& error) {
+        std::cerr << "Error: " << error.what() << "\n";
+        return 2;
+    }
+}
@@ -0,0 +1,259 @@
+//Generates synthetic SDF files (e.g. for benchmarking)
+//
+//The size of the file is controlled either by the number of cells, or by a
+//target size in bytes (in which case cells are generated until the output
+//reaches that size). Output is deterministic for a given seed.
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <iostream>
+#include <memory>
+
+namespace /*anonymous*/ {
+
+struct Options {
+    uint64_t num_cells = 1000;
+    uint64_t target_size = 0; //Bytes, 0 to use num_cells
+    unsigned iopaths_per_cell = 2;
+    unsigned timing_checks_per_cell = 0;
+    double escaped_fraction = 0.1; //Fraction of instances with escaped characters
+    double edge_fraction = 0.1; //Fraction of IOPATHs/timing checks with edge conditions
+    uint64_t seed = 1;
+    std::string output = "-";
+};
+
+//Writes SDF text through a large buffer
+class Output {
+    public:
+        Output(FILE* file)
+            : file_(file)
+            {}
+        ~Output() { flush(); }
+
+        void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+        void flush() {
+            if(std::fwrite(buf_, 1, len_, file_) != len_) {
+                std::perror("write");
+                std::exit(1);
+            }
+            len_ = 0;
+        }
+
+        uint64_t bytes_written() const { return bytes_written_; }
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 1 << 20;
+        static constexpr size_t MAX_LINE = 4096;
+
+        FILE* file_;
+        char buf_[BUFFER_SIZE];
+        size_t len_ = 0;
+        uint64_t bytes_written_ = 0;
+};
+
+void print_usage(const char* prog);
+bool parse_size(const char* str, uint64_t& size);
+bool parse_args(int argc, char** argv, Options& options);
+void write_triple(Output& out, std::mt19937_64& rng, const char* suffix);
+void write_port(Output& out, std::mt19937_64& rng, const Options& options, const char* port);
+void write_cell(Output& out, std::mt19937_64& rng, const Options& options, uint64_t icell);
+
+void Output::printf(const char* fmt, ...) {
+    if(BUFFER_SIZE - len_ < MAX_LINE) {
+        flush();
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int len = std::vsnprintf(buf_ + len_, MAX_LINE, fmt, args);
+    va_end(args);
+
+    len_ += len;
+    bytes_written_ += len;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --cells N           Number of cells (default: 1000)\n"
+              << "  --size SIZE         Generate cells until the file reaches SIZE bytes\n"
+              << "                      (suffixes K, M, G allowed; overrides --cells)\n"
+              << "  --iopaths N         IOPATHs per cell (default: 2)\n"
+              << "  --timing-checks N   Timing checks per cell (default: 0)\n"
+              << "  --escaped FRAC      Fraction of instance names with escaped characters (default: 0.1)\n"
+              << "  --edges FRAC        Fraction of ports with posedge/negedge conditions (default: 0.1)\n"
+              << "  --seed N            Random seed (default: 1)\n"
+              << "  -o FILE             Output file (default: stdout)\n";
+}
+
+bool parse_size(const char* str, uint64_t& size) {
+    char* end;
+    double value = std::strtod(str, &end);
+    if(end == str || value < 0) {
+        return false;
+    }
+    switch(*end) {
+        case '\0': break;
+        case 'k': case 'K': value *= 1e3; break;
+        case 'm': case 'M': value *= 1e6; break;
+        case 'g': case 'G': value *= 1e9; break;
+        default: return false;
+    }
+    size = uint64_t(value);
+    return true;
+}
+
+bool parse_args(int argc, char** argv, Options& options) {
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(i + 1 >= argc) {
+            return false; //All options take a value
+        }
+        const char* value = argv[++i];
+
+        if(arg == "--cells") {
+            options.num_cells = std::strtoull(value, nullptr, 10);
+        } else if(arg == "--size") {
+            if(!parse_size(value, options.target_size)) {
+                return false;
+            }
+        } else if(arg == "--iopaths") {
+            options.iopaths_per_cell = std::atoi(value);
+        } else if(arg == "--timing-checks") {
+            options.timing_checks_per_cell = std::atoi(value);
+        } else if(arg == "--escaped") {
+            options.escaped_fraction = std::atof(value);
+        } else if(arg == "--edges") {
+            options.edge_fraction = std::atof(value);
+        } else if(arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if(arg == "-o") {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_triple(Output& out, std::mt19937_64& rng, const char* suffix) {
+    //Mostly integral delays, with some fractional ones
+    unsigned min = 10 + rng() % 990;
+    unsigned typ = min + rng() % 100;
+    unsigned max = typ + rng() % 100;
+    if(rng() % 4 == 0) {
+        out.printf("(%u.%03u:%u.%03u:%u.%03u)%s", min, unsigned(rng() % 1000), typ, unsigned(rng() % 1000),
+                   max, unsigned(rng() % 1000), suffix);
+    } else {
+        out.printf("(%u:%u:%u)%s", min, typ, max, suffix);
+    }
+}
+
+void write_port(Output& out, std::mt19937_64& rng, const Options& options, const char* port) {
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    if(uniform(rng) < options.edge_fraction) {
+        out.printf("(%s %s)", (rng() % 2) ? "posedge" : "negedge", port);
+    } else {
+        out.printf("%s", port);
+    }
+}
+
+void write_cell(Output& out, std::mt19937_64& rng, const Options& options, uint64_t icell) {
+    static const char* CELLTYPES[] = {"DFFR_X1", "NAND2_X1", "NOR2_X2", "INV_X4", "AOI21_X1", "MUX2_X1", "BUF_X8", "XOR2_X1"};
+    static const char* INPUTS[] = {"A", "B", "C", "D", "S", "CK", "A1", "A2"};
+    static const char* OUTPUTS[] = {"Z", "ZN", "Q", "QN", "Y"};
+
+    std::uniform_real_distribution<double> uniform(0., 1.);
+
+    out.printf("  (CELL\n");
+    out.printf("    (CELLTYPE \"%s\")\n", CELLTYPES[rng() % 8]);
+
+    //Hierarchical instance names, some with escaped characters (e.g. from bus bits)
+    unsigned block = unsigned(icell / 1024);
+    if(uniform(rng) < options.escaped_fraction) {
+        out.printf("    (INSTANCE top/core_%u/u_blk_%u/data_reg\\[%u\\]\\.q_%llu)\n",
+                   block % 16, block, unsigned(icell % 64), (unsigned long long) icell);
+    } else {
+        out.printf("    (INSTANCE top/core_%u/u_blk_%u/u_%llu)\n", block % 16, block, (unsigned long long) icell);
+    }
+
+    if(options.iopaths_per_cell > 0) {
+        out.printf("    (DELAY\n      (ABSOLUTE\n");
+        for(unsigned i = 0; i < options.iopaths_per_cell; ++i) {
+            out.printf("        (IOPATH ");
+            write_port(out, rng, options, INPUTS[i % 8]);
+            out.printf(" %s ", OUTPUTS[i % 5]);
+            write_triple(out, rng, " ");
+            write_triple(out, rng, ")\n");
+        }
+        out.printf("      )\n    )\n");
+    }
+
+    if(options.timing_checks_per_cell > 0) {
+        static const char* CHECKS[] = {"SETUP", "HOLD", "RECOVERY", "REMOVAL"};
+        out.printf("    (TIMINGCHECK\n");
+        for(unsigned i = 0; i < options.timing_checks_per_cell; ++i) {
+            out.printf("      (%s D ", CHECKS[i % 4]);
+            write_port(out, rng, options, "CK");
+            out.printf(" ");
+            write_triple(out, rng, ")\n");
+        }
+        out.printf("    )\n");
+    }
+
+    out.printf("  )\n");
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_args(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    FILE* file = stdout;
+    if(options.output != "-") {
+        file = std::fopen(options.output.c_str(), "wb");
+        if(!file) {
+            std::perror(options.output.c_str());
+            return 1;
+        }
+    }
+
+    std::mt19937_64 rng(options.seed);
+    {
+        std::unique_ptr<Output> out(new Output(file));
+
+        out->printf("(DELAYFILE\n");
+        out->printf("  (SDFVERSION \"3.0\")\n");
+        out->printf("  (DESIGN \"top\")\n");
+        out->printf("  (VENDOR \"sdfparse\")\n");
+        out->printf("  (PROGRAM \"sdfparse_gen\")\n");
+        out->printf("  (VERSION \"1.0\")\n");
+        out->printf("  (DIVIDER /)\n");
+        out->printf("  (TIMESCALE 1 ps)\n");
+
+        for(uint64_t icell = 0; ; ++icell) {
+            bool done = (options.target_size > 0) ? out->bytes_written() >= options.target_size
+                                                  : icell >= options.num_cells;
+            if(done) {
+                break;
+            }
+            write_cell(*out, rng, options, icell);
+        }
+
+        out->printf(")\n");
+    }
+
+    if(file != stdout && std::fclose(file) != 0) {
+        std::perror(options.output.c_str());
+        return 1;
+    }
+    return 0;
+}